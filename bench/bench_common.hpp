@@ -0,0 +1,25 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// runs fn `iterations` times and prints the time per iteration and per item
+template <typename Fn>
+double bench(const std::string& name, int iterations, std::size_t items, Fn&& fn) {
+    fn(); // warm up
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+        iterations;
+    std::printf("%-40s %12.0f ns/iter %10.2f ns/item\n", name.c_str(), ns,
+                items ? ns / items : 0.0);
+    return ns;
+}
+
+// keeps the optimizer from dropping a computed value
+template <typename T> void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
@@ -0,0 +1,97 @@
+// Response serialization: the nlohmann -> to_crow_json -> wvalue::dump round
+// trip against nlohmann's own dump and the streaming JsonWriter.
+#include "bench_common.hpp"
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "utils/JsonWriter.hpp"
+#include "utils/Json_utils.hpp"
+
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+int main() {
+    for (std::size_t count : {10, 100, 1000}) {
+        std::vector<cc::models::Food> foods;
+        std::vector<cc::models::MealLog> meals;
+        for (std::size_t i = 0; i < count; i++) {
+            cc::models::Food food;
+            food.setId(std::to_string(4000000000000 + i));
+            food.setBarcode(food.id());
+            food.setName("Rolled oats, whole grain");
+            food.setBrand("bench");
+            food.setCaloriesPer100g(50.5 + i % 300);
+            food.setNutrients({{cc::models::NutrientType::Protein, i % 30 * 1.1, "g"},
+                               {cc::models::NutrientType::Carbs, i % 70 * 0.9, "g"},
+                               {cc::models::NutrientType::Fat, i % 20 * 0.7, "g"},
+                               {cc::models::NutrientType::Sodium, i % 500 * 1.0, "mg"}});
+            foods.push_back(food);
+
+            cc::models::MealLog meal;
+            meal.setFoodItems({{food.id(), 80.0}, {"3017620422003", 15.5}, {"7", 200.0}});
+            cc::models::NutritionTotals totals;
+            totals.add(food, 80.0);
+            meal.setNutrition(totals);
+            meals.push_back(meal);
+        }
+        const int iterations = count >= 1000 ? 50 : 500;
+        std::printf("\n%zu foods / meals\n", count);
+
+        bench("foods: nlohmann + to_crow_json + dump", iterations, count, [&] {
+            nlohmann::json j = foods;
+            doNotOptimize(cc::utils::to_crow_json(j).dump());
+        });
+        bench("foods: nlohmann dump", iterations, count, [&] {
+            nlohmann::json j = foods;
+            doNotOptimize(j.dump());
+        });
+        bench("foods: JsonWriter", iterations, count, [&] {
+            cc::utils::JsonWriter w(64 + foods.size() * 384);
+            w.beginArray();
+            for (const auto& food : foods) {
+                cc::utils::writeJson(w, food);
+            }
+            w.endArray();
+            doNotOptimize(w.take());
+        });
+
+        bench("meals: nlohmann + to_crow_json + dump", iterations, count, [&] {
+            nlohmann::json j = meals;
+            doNotOptimize(cc::utils::to_crow_json(j).dump());
+        });
+        bench("meals: nlohmann dump", iterations, count, [&] {
+            nlohmann::json j = meals;
+            doNotOptimize(j.dump());
+        });
+        bench("meals: JsonWriter", iterations, count, [&] {
+            cc::utils::JsonWriter w(64 + meals.size() * 384);
+            w.beginArray();
+            for (const auto& meal : meals) {
+                cc::utils::writeJson(w, meal);
+            }
+            w.endArray();
+            doNotOptimize(w.take());
+        });
+    }
+
+    std::printf("\nnumber formatting\n");
+    std::vector<double> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(i * 1.37 + 0.001 * i);
+    }
+    bench("double: nlohmann dump", 1000, values.size(), [&] {
+        for (double v : values) {
+            doNotOptimize(nlohmann::json(v).dump());
+        }
+    });
+    bench("double: appendDouble", 1000, values.size(), [&] {
+        std::string out;
+        out.reserve(values.size() * 24);
+        for (double v : values) {
+            cc::utils::appendDouble(out, v);
+        }
+        doNotOptimize(out);
+    });
+    return 0;
+}
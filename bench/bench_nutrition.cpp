@@ -0,0 +1,108 @@
+// Meal totals: Server::enrichMeals (foods resolved once through FoodService,
+// then a pass over the items) against the columnar NutritionTable kernels.
+#include "api/Server.hpp"
+#include "bench_common.hpp"
+#include "clients/OpenFoodFactsClient.hpp"
+#include "models/nutrition_table.hpp"
+#include "services/FoodService.hpp"
+#include "services/MealService.hpp"
+#include "storage/JsonFoodRepository.hpp"
+#include "storage/JsonMealRepository.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main() {
+    constexpr int FOODS = 500;
+    const std::string food_db = "/tmp/cc_bench_nutrition_food_db.json";
+    const std::string meal_db = "/tmp/cc_bench_nutrition_meal_db.json";
+    std::remove(food_db.c_str());
+    std::remove(meal_db.c_str());
+
+    auto food_service = std::make_shared<cc::services::FoodService>(
+        std::make_shared<cc::storage::JsonFoodRepository>(food_db),
+        std::make_shared<cc::clients::OpenFoodFactsClient>());
+    auto meal_service = std::make_shared<cc::services::MealService>(
+        std::make_shared<cc::storage::JsonMealRepository>(meal_db));
+    cc::api::Server server(0, food_service, meal_service);
+
+    std::vector<cc::models::Food> foods;
+    for (int i = 0; i < FOODS; i++) {
+        cc::models::Food food;
+        food.setId(std::to_string(1000 + i));
+        food.setBarcode(food.id());
+        food.setName("food");
+        food.setBrand("bench");
+        food.setCaloriesPer100g(50 + i % 300);
+        food.setNutrients({{cc::models::NutrientType::Protein, i % 30 * 1.0, "g"},
+                           {cc::models::NutrientType::Carbs, i % 70 * 1.0, "g"},
+                           {cc::models::NutrientType::Fat, i % 20 * 1.0, "g"}});
+        food_service->addManualFood(food);
+        foods.push_back(food);
+    }
+
+    cc::models::NutritionTable table;
+    for (const auto& food : foods) {
+        table.upsert(food.id(), food);
+    }
+    std::vector<double> kcal;
+    std::array<std::vector<double>, cc::models::NUTRIENTS.size()> values;
+    for (const auto& food : foods) {
+        kcal.push_back(food.caloriesPer100g());
+        for (const auto& info : cc::models::NUTRIENTS) {
+            values[cc::models::nutrientIndex(info.type)].push_back(food.nutrient(info.type));
+        }
+    }
+    cc::models::NutritionColumns columns{kcal.data(), {}};
+    for (std::size_t i = 0; i < values.size(); i++) {
+        columns.nutrients[i] = values[i].data();
+    }
+
+    std::printf("detected simd level: %d (0 scalar, 1 sse2, 2 avx2)\n",
+                static_cast<int>(cc::models::detectSimdLevel()));
+    for (std::size_t items : {8, 64, 1024}) {
+        std::printf("\n%zu items per meal\n", items);
+        std::vector<std::pair<std::string, double>> food_items;
+        std::vector<std::uint32_t> slots;
+        std::vector<double> grams;
+        for (std::size_t i = 0; i < items; i++) {
+            const int f = static_cast<int>(i * 37 % FOODS);
+            food_items.emplace_back(foods[f].id(), 10.0 + i % 90);
+            slots.push_back(f);
+            grams.push_back(food_items.back().second);
+        }
+        cc::models::MealLog meal;
+        meal.setFoodItems(food_items);
+        const int iterations = items >= 1024 ? 50 : 500;
+
+        bench("Server::enrichMeals", iterations, items, [&] {
+            std::vector<cc::models::MealLog> meals{meal};
+            server.enrichMeals(meals);
+            doNotOptimize(meals);
+        });
+        bench("FoodService::nutritionTotals", iterations * 10, items, [&] {
+            doNotOptimize(food_service->nutritionTotals(food_items));
+        });
+        bench("NutritionTable::totals", iterations * 10, items,
+              [&] { doNotOptimize(table.totals(food_items)); });
+        for (auto level : {cc::models::SimdLevel::Scalar, cc::models::SimdLevel::SSE2,
+                           cc::models::SimdLevel::AVX2}) {
+            if (level > cc::models::detectSimdLevel()) continue;
+            bench(std::string("kernel level ") + std::to_string(static_cast<int>(level)),
+                  iterations * 100, items, [&] {
+                      doNotOptimize(cc::models::accumulateNutrition(
+                          columns, slots.data(), grams.data(), slots.size(), level));
+                  });
+        }
+    }
+
+    std::remove(food_db.c_str());
+    std::remove(meal_db.c_str());
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Server throughput across Crow worker counts: keep-alive clients hammer
+// /health (dispatch only) and /foods (service + JSON) on a local port.
+// Usage: cc_bench_server_threads [seconds per run] [client connections]
+#include "api/Server.hpp"
+#include "clients/OpenFoodFactsClient.hpp"
+#include "services/FoodService.hpp"
+#include "services/MealService.hpp"
+#include "storage/JsonFoodRepository.hpp"
+#include "storage/JsonMealRepository.hpp"
+#include "utils/ThreadLayout.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// one keep-alive HTTP/1.1 connection, reads responses by Content-Length
+class Connection {
+  public:
+    explicit Connection(int port) {
+        this->fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        ::setsockopt(this->fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        this->ok_ = ::connect(this->fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    ~Connection() { ::close(this->fd_); }
+
+    bool get(const std::string& request) {
+        if (!this->ok_ || ::send(this->fd_, request.data(), request.size(), MSG_NOSIGNAL) < 0) {
+            return false;
+        }
+        while (true) {
+            const std::size_t end = this->buf_.find("\r\n\r\n");
+            if (end != std::string::npos) {
+                std::size_t length = 0;
+                const std::size_t at = this->buf_.find("Content-Length: ");
+                if (at != std::string::npos && at < end) {
+                    length = std::strtoull(this->buf_.c_str() + at + 16, nullptr, 10);
+                }
+                if (this->buf_.size() >= end + 4 + length) {
+                    this->buf_.erase(0, end + 4 + length);
+                    return true;
+                }
+            }
+            char chunk[16384];
+            const ssize_t n = ::recv(this->fd_, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            this->buf_.append(chunk, static_cast<std::size_t>(n));
+        }
+    }
+
+  private:
+    int fd_;
+    bool ok_{false};
+    std::string buf_;
+};
+
+// requests per second of `clients` connections sending `path` for `seconds`
+double measure(int port, const std::string& path, int clients, double seconds) {
+    const std::string request =
+        "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> done{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&] {
+            Connection conn(port);
+            std::uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed) && conn.get(request)) n++;
+            done += n;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& t : threads) t.join();
+    return static_cast<double>(done.load()) / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+    const int clients = argc > 2 ? std::atoi(argv[2]) : 64;
+    const std::string food_db = "/tmp/cc_bench_server_threads_food_db.json";
+    const std::string meal_db = "/tmp/cc_bench_server_threads_meal_db.json";
+    std::remove(food_db.c_str());
+    std::remove(meal_db.c_str());
+
+    auto food_service = std::make_shared<cc::services::FoodService>(
+        std::make_shared<cc::storage::JsonFoodRepository>(food_db),
+        std::make_shared<cc::clients::OpenFoodFactsClient>());
+    auto meal_service = std::make_shared<cc::services::MealService>(
+        std::make_shared<cc::storage::JsonMealRepository>(meal_db));
+    for (int i = 0; i < 200; i++) {
+        cc::models::Food food;
+        food.setId(std::to_string(1000 + i));
+        food.setBarcode(food.id());
+        food.setName("food");
+        food.setBrand("bench");
+        food.setCaloriesPer100g(50 + i % 300);
+        food.setNutrients({{cc::models::NutrientType::Protein, i % 30 * 1.0, "g"}});
+        food_service->addManualFood(food);
+    }
+
+    std::vector<unsigned> workers{1, 2, 4, 8, 16};
+    const unsigned hardware = cc::utils::hardwareThreads();
+    workers.erase(std::remove_if(workers.begin(), workers.end(),
+                                 [&](unsigned w) { return w > 2 * hardware; }),
+                  workers.end());
+    if (std::find(workers.begin(), workers.end(), hardware) == workers.end()) {
+        workers.push_back(hardware);
+    }
+    std::printf("%u hardware threads, %d connections, %.1fs per run\n", hardware, clients,
+                seconds);
+    std::printf("%-10s %16s %16s\n", "workers", "/health req/s", "/foods req/s");
+    int port = 18300;
+    for (unsigned w : workers) {
+        cc::api::Server server(port, food_service, meal_service);
+        cc::utils::ThreadLayout layout;
+        layout.httpWorkers = w;
+        server.configureThreads(layout);
+        server.start();
+        const double health = measure(port, "/health", clients, seconds);
+        const double foods = measure(port, "/foods?limit=20", clients, seconds);
+        std::printf("%-10u %16.0f %16.0f\n", w, health, foods);
+        server.stop();
+        port++;
+    }
+
+    std::remove(food_db.c_str());
+    std::remove(meal_db.c_str());
+    return 0;
+}
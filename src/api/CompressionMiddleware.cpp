@@ -0,0 +1,73 @@
+#include "api/CompressionMiddleware.hpp"
+
+#include "utils/RequestTiming.hpp"
+
+#include <format>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace cc::api {
+
+CompressionMiddleware::CompressionMiddleware()
+    : min_bytes_{Options{}.minBytes},
+      level_{Options{}.level},
+      cache_{Options{}.cacheBytes} {}
+
+void CompressionMiddleware::configure(const Options& options) {
+  this->min_bytes_ = options.minBytes;
+  this->level_ = options.level;
+  this->cache_.configure(options.cacheBytes, cc::utils::CachePolicy::LRU);
+}
+
+CompressionMiddleware::Options CompressionMiddleware::options() const {
+  return Options{this->min_bytes_, this->level_,
+                 this->cache_.stats().budgetBytes};
+}
+
+CompressionMiddleware::BodyCache::Stats CompressionMiddleware::cacheStats()
+    const {
+  return this->cache_.stats();
+}
+
+void CompressionMiddleware::before_handle(crow::request&, crow::response&,
+                                          context&) {}
+
+void CompressionMiddleware::after_handle(crow::request& req,
+                                         crow::response& res, context&) {
+  if (res.code != 200 || res.body.size() < this->min_bytes_) return;
+  if (!res.get_header_value("Content-Encoding").empty()) return;
+  // caches must keep the codings apart
+  res.add_header("Vary", "Accept-Encoding");
+  const auto encoding =
+      cc::utils::negotiateEncoding(req.get_header_value("Accept-Encoding"));
+  if (encoding == cc::utils::ContentEncoding::Identity) return;
+
+  // the tag is per URL, so is the cached body
+  const std::string etag = res.get_header_value("ETag");
+  std::optional<std::string> key;
+  if (!etag.empty()) {
+    key = std::format("{} {} {}", cc::utils::encodingName(encoding),
+                      req.raw_url, etag);
+  }
+  std::optional<std::string> body;
+  if (key) body = this->cache_.get(*key);
+  if (!body) {
+    cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Compress);
+    auto compressed =
+        cc::utils::compress(res.body, encoding, this->level_.load());
+    // sent uncompressed rather than failing the request
+    if (!compressed) return;
+    body = compressed.unwrap();
+    if (key) this->cache_.put(*key, *body, key->size() + body->size());
+  }
+  res.body = std::move(*body);
+  res.set_header("Content-Encoding", std::string(cc::utils::encodingName(encoding)));
+  // the compressed bytes are another representation: a weak tag still
+  // revalidates (If-None-Match ignores W/) without claiming byte equality
+  if (!etag.empty() && !etag.starts_with("W/")) {
+    res.set_header("ETag", "W/" + etag);
+  }
+}
+
+}  // namespace cc::api
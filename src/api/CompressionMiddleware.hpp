@@ -0,0 +1,47 @@
+#pragma once
+#include <crow.h>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+#include "utils/BoundedCache.hpp"
+#include "utils/Compression.hpp"
+
+namespace cc::api {
+
+// Compresses 200 responses with gzip or deflate, as negotiated with the
+// client's Accept-Encoding. Small bodies are sent as is. Bodies of responses
+// that carry an ETag are cached per URL, tag and coding, so repeated reads
+// of unchanged data are not compressed again.
+class CompressionMiddleware {
+  public:
+    struct Options {
+        // bodies below this many bytes are not compressed
+        std::size_t minBytes = 1024;
+        // zlib level 1 (fastest) .. 9 (smallest)
+        int level = 6;
+        // memory of the compressed body cache, 0 disables it
+        std::size_t cacheBytes = 4 * 1024 * 1024;
+    };
+    using BodyCache = cc::utils::BoundedCache<std::string, std::string>;
+
+    struct context {};
+
+    CompressionMiddleware();
+
+    // drops the cached bodies, they were compressed at the old level
+    void configure(const Options& options);
+    Options options() const;
+    BodyCache::Stats cacheStats() const;
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+  private:
+    std::atomic<std::size_t> min_bytes_;
+    std::atomic<int> level_;
+    mutable BodyCache cache_;
+};
+
+} // namespace cc::api
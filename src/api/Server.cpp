@@ -6,15 +6,23 @@
 #include <crow/http_response.h>
 #include <crow/json.h>
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <exception>
+#include <filesystem>
 #include <format>
+#include <fstream>
 #include <iostream>
 #include <magic_enum.hpp>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -22,74 +30,557 @@
 #include "models/meal_log.hpp"
 #include "models/nutrient.hpp"
 #include "nlohmann/json.hpp"
+#include "utils/ExportFormat.hpp"
+#include "utils/NdjsonImport.hpp"
+#include "utils/RequestTiming.hpp"
 #include "utils/Result.hpp"
+#include "utils/ThreadLayout.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/date_time_utils.hpp"
 
 namespace cc {
 namespace api {
 
+namespace {
+// totals of a day range with per day averages, shared by the stats routes;
+// leaves the object open so callers can add fields
+void writePeriod(cc::utils::JsonWriter& w, std::chrono::sys_days start,
+                 std::chrono::sys_days end,
+                 const cc::services::DailyTotals& totals) {
+  const int days = (end - start).count() + 1;
+  auto avg = [days](double v) { return std::round(v / days * 10) / 10; };
+  w.beginObject();
+  w.field("start", std::format("{:%F}", start));
+  w.field("end", std::format("{:%F}", end));
+  w.field("days", days);
+  w.field("mealsCount", totals.mealsCount);
+  w.field("pendingMeals", totals.pendingMeals);
+  w.field("totalCalories", (int)std::round(totals.totals.calories));
+  w.field("avgCalories", avg(totals.totals.calories));
+  for (const auto& info : cc::models::NUTRIENTS) {
+    const std::string_view name = magic_enum::enum_name(info.type);
+    w.field(name, (int)std::round(totals.totals[info.type]));
+    w.key(std::format("avg{}", name)).value(avg(totals.totals[info.type]));
+  }
+}
+
+// true if the If-None-Match header lists the etag (or is "*"), weak
+// validators compare equal to the strong ones for GET
+bool etagMatches(const crow::request& req, std::string_view etag) {
+  const std::string& header = req.get_header_value("If-None-Match");
+  if (header.empty()) return false;
+  std::string_view rest = header;
+  while (!rest.empty()) {
+    const std::size_t comma = rest.find(',');
+    std::string_view tag = rest.substr(0, comma);
+    rest = comma == std::string_view::npos ? std::string_view{}
+                                           : rest.substr(comma + 1);
+    while (!tag.empty() && tag.front() == ' ') tag.remove_prefix(1);
+    while (!tag.empty() && tag.back() == ' ') tag.remove_suffix(1);
+    if (tag.starts_with("W/")) tag.remove_prefix(2);
+    if (tag == "*" || tag == etag) return true;
+  }
+  return false;
+}
+
+crow::response notModified(const std::string& etag) {
+  crow::response res(304);
+  res.set_header("ETag", etag);
+  return res;
+}
+
+crow::response withEtag(crow::response res, const std::string& etag) {
+  if (res.code == 200) res.set_header("ETag", etag);
+  return res;
+}
+
+// records per repository write of the bulk imports, each write rewrites
+// the data base file
+constexpr std::size_t IMPORT_BATCH_SIZE = 500;
+
+// per line errors and throughput of a bulk import
+crow::response importResponse(const cc::utils::ImportReport& report) {
+  cc::utils::JsonWriter w(256 + report.errors.size() * 64);
+  w.beginObject();
+  w.field("lines", report.lines);
+  w.field("imported", report.imported);
+  w.field("failed", report.failed);
+  w.field("batches", report.batches);
+  w.field("elapsedMs",
+          std::chrono::duration<double, std::milli>(report.elapsed).count());
+  w.field("recordsPerSecond", std::round(report.recordsPerSecond()));
+  w.key("errors").beginArray();
+  for (const auto& error : report.errors) {
+    w.beginObject();
+    w.field("line", error.line);
+    w.field("error", error.message);
+    w.endObject();
+  }
+  w.endArray();
+  w.endObject();
+  return cc::utils::json_response(report.lines ? 200 : 400, w.take());
+}
+
+// records per repository batch of the exports
+constexpr std::size_t EXPORT_BATCH_SIZE = 256;
+
+// An export is written to a temp file a batch at a time and Crow sends the
+// file in chunks, so neither holds the whole export in memory. Crow opens
+// the file as soon as the handler returns; the files of earlier exports
+// are removed by the next one (an open file stays readable once removed).
+struct ExportFile {
+  std::filesystem::path path;
+  std::ofstream out;
+  // rows of the current batch
+  std::string buffer;
+
+  bool flush() {
+    this->out.write(this->buffer.data(),
+                    static_cast<std::streamsize>(this->buffer.size()));
+    this->buffer.clear();
+    return static_cast<bool>(this->out);
+  }
+};
+
+ExportFile openExport(std::string_view name) {
+  using namespace std::chrono_literals;
+  static std::atomic<std::uint64_t> next_export{0};
+  std::error_code ec;
+  const auto dir = std::filesystem::temp_directory_path(ec) / "cc-exports";
+  std::filesystem::create_directories(dir, ec);
+  const auto now = std::filesystem::file_time_type::clock::now();
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.is_regular_file(ec) && now - entry.last_write_time(ec) > 1min) {
+      std::filesystem::remove(entry.path(), ec);
+    }
+  }
+  ExportFile file;
+  file.path = dir / std::format("{}-{}-{}", name,
+                                std::chrono::steady_clock::now()
+                                    .time_since_epoch()
+                                    .count(),
+                                next_export++);
+  file.out.open(file.path, std::ios::binary | std::ios::trunc);
+  return file;
+}
+
+crow::response exportResponse(cc::utils::ExportFormat format,
+                              std::string_view name, ExportFile& file) {
+  const bool written = file.flush();
+  file.out.close();
+  if (!written || file.out.fail()) {
+    std::error_code ec;
+    std::filesystem::remove(file.path, ec);
+    crow::json::wvalue response_json;
+    response_json["error"] = "can't write the export";
+    return crow::response(500, response_json);
+  }
+  crow::response res;
+  res.set_static_file_info_unsafe(file.path.string());
+  res.set_header("Content-Type", std::string(cc::utils::contentType(format)));
+  res.set_header("Content-Disposition",
+                 std::format("attachment; filename=\"{}.{}\"", name,
+                             format == cc::utils::ExportFormat::Csv ? "csv"
+                                                                    : "ndjson"));
+  return res;
+}
+
+// the JSON body of a request, timed as its parse phase
+crow::json::rvalue loadBody(const crow::request& req) {
+  cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Parse);
+  return crow::json::load(req.body);
+}
+
+crow::response mealsResponse(const std::vector<cc::models::MealLog>& meals) {
+  cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+  cc::utils::JsonWriter w(64 + meals.size() * 320);
+  w.beginArray();
+  for (const auto& meal : meals) {
+    cc::utils::writeJson(w, meal);
+  }
+  w.endArray();
+  return cc::utils::json_response(200, w.take());
+}
+}  // namespace
+
 Server::Server(int port, std::shared_ptr<cc::services::FoodService> foodService,
                std::shared_ptr<cc::services::MealService> mealService)
-    : port_{port}, foodService_{foodService}, mealService_{mealService} {}
+    : port_{port}, foodService_{foodService}, mealService_{mealService} {
+  this->registerMetrics();
+}
 Server::~Server() { this->stop(); }
 
-cc::utils::Result<void> Server::calculateCalories(nlohmann::json& meal) {
-  double totalKcal = 0;
-  for (auto food_dic : meal.at("foodItems")) {
-    cc::utils::Result<cc::models::Food> food_result =
-        this->foodService_->getOrFetchByBarcode(food_dic[0].get<std::string>());
-    if (food_result) {
-      cc::models::Food food = food_result.unwrap();
-      totalKcal += food.totalKcal(food_dic[1].get<double>());
-    } else {
-      return cc::utils::Result<void>::fail(food_result.unwrap_error().code,
-                                           food_result.unwrap_error().message);
+void Server::configureCompression(
+    const CompressionMiddleware::Options& options) {
+  this->app.get_middleware<CompressionMiddleware>().configure(options);
+}
+
+void Server::configureRateLimit(
+    const middleware::RateLimit::Options& options) {
+  this->app.get_middleware<middleware::RateLimit>().configure(options);
+}
+
+void Server::registerMetrics() {
+  using cc::utils::MetricType;
+  auto foodCache = [this](auto field) {
+    return [this, field] {
+      return static_cast<double>(this->foodService_->cacheStats().*field);
+    };
+  };
+  using FoodCacheStats = cc::services::FoodService::FoodCache::Stats;
+  this->metrics_.callback("cc_food_cache_entries", "Foods in the decoded food cache",
+                          MetricType::Gauge, foodCache(&FoodCacheStats::entries));
+  this->metrics_.callback("cc_food_cache_bytes", "Approximate memory of the food cache",
+                          MetricType::Gauge, foodCache(&FoodCacheStats::bytes));
+  this->metrics_.callback("cc_food_cache_hits_total", "Food cache hits",
+                          MetricType::Counter, foodCache(&FoodCacheStats::hits));
+  this->metrics_.callback("cc_food_cache_misses_total", "Food cache misses",
+                          MetricType::Counter, foodCache(&FoodCacheStats::misses));
+  this->metrics_.callback("cc_food_cache_evictions_total",
+                          "Foods evicted from the cache over its budget",
+                          MetricType::Counter,
+                          foodCache(&FoodCacheStats::evictions));
+
+  auto bodies = [this](auto field) {
+    return [this, field] {
+      return static_cast<double>(
+          this->app.get_middleware<CompressionMiddleware>().cacheStats().*field);
+    };
+  };
+  using BodyCacheStats = CompressionMiddleware::BodyCache::Stats;
+  this->metrics_.callback("cc_compression_cache_bytes",
+                          "Memory of the cached compressed bodies",
+                          MetricType::Gauge, bodies(&BodyCacheStats::bytes));
+  this->metrics_.callback("cc_compression_cache_hits_total",
+                          "Responses sent from the compressed body cache",
+                          MetricType::Counter, bodies(&BodyCacheStats::hits));
+  this->metrics_.callback("cc_compression_cache_misses_total",
+                          "Cacheable responses compressed again",
+                          MetricType::Counter, bodies(&BodyCacheStats::misses));
+
+  // the resolver may be set after the server is built
+  auto resolver = [this](auto field) {
+    return [this, field] {
+      auto resolver = this->mealService_->foodResolver();
+      return resolver ? static_cast<double>(resolver->stats().*field) : 0.0;
+    };
+  };
+  using ResolverStats = cc::services::FoodResolver::Stats;
+  this->metrics_.callback("cc_resolver_queue_depth",
+                          "Unknown foods waiting for the background resolver",
+                          MetricType::Gauge, resolver(&ResolverStats::queueDepth));
+  this->metrics_.callback("cc_resolver_resolved_total",
+                          "Foods resolved in the background", MetricType::Counter,
+                          resolver(&ResolverStats::resolved));
+  this->metrics_.callback("cc_resolver_failed_total",
+                          "Background food resolutions that failed",
+                          MetricType::Counter, resolver(&ResolverStats::failed));
+
+  this->metrics_.callback("cc_thread_pool_workers", "Workers of the shared pool",
+                          MetricType::Gauge, [] {
+                            return double(cc::utils::ThreadPool::shared().size());
+                          });
+  this->metrics_.callback("cc_thread_pool_pending",
+                          "Tasks queued in the shared pool", MetricType::Gauge, [] {
+                            return double(
+                                cc::utils::ThreadPool::shared().pending());
+                          });
+}
+
+void Server::configureThreads(const cc::utils::ThreadLayout& layout) {
+  this->threads_ = layout;
+}
+
+cc::utils::Result<void> Server::enrichMeals(
+    std::span<cc::models::MealLog> meals) {
+  cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Enrich);
+  // smaller chunks cost more in scheduling than they save
+  constexpr std::size_t MEALS_PER_CHUNK = 32;
+
+  // distinct foods of the meals whose nutrition is not materialized yet,
+  // resolved in one batch however many meals share them
+  std::vector<std::string> food_ids;
+  std::unordered_map<std::string, std::size_t> food_index;
+  for (const auto& meal : meals) {
+    if (meal.nutrition()) continue;
+    for (const auto& [food_id, grams] : meal.food_items()) {
+      if (food_index.emplace(food_id, food_ids.size()).second) {
+        food_ids.push_back(food_id);
+      }
+    }
+  }
+  std::vector<cc::utils::Result<cc::models::Food>> foods;
+  if (!food_ids.empty()) {
+    foods = this->foodService_->getOrFetchMany(food_ids);
+  }
+
+  // kcal and every nutrient in one pass over the items, in place so the
+  // order is kept; a meal with an unresolved food is left without totals
+  std::vector<std::optional<cc::utils::Error>> errors(meals.size());
+  cc::utils::ThreadPool::shared().parallelFor(
+      meals.size(), MEALS_PER_CHUNK, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+          cc::models::MealLog& meal = meals[i];
+          cc::models::NutritionTotals totals;
+          if (meal.nutrition()) {
+            totals = *meal.nutrition();
+          } else {
+            for (const auto& [food_id, grams] : meal.food_items()) {
+              const auto& food = foods[food_index.at(food_id)];
+              if (!food) {
+                errors[i] = food.unwrap_error();
+                break;
+              }
+              totals.add(food.unwrap(), grams);
+            }
+            if (errors[i]) continue;
+          }
+          // nutrients are reported in whole units, kcal as computed
+          for (const auto& info : cc::models::NUTRIENTS) {
+            totals[info.type] = std::round(totals[info.type]);
+          }
+          meal.setNutrition(totals);
+        }
+      });
+  for (const auto& error : errors) {
+    if (error) {
+      return cc::utils::Result<void>::fail(error->code, error->message);
     }
   }
-  //meal["calories"] = std::format("{:.2f}", totalKcal);
-  meal["calories"] = totalKcal;
   return cc::utils::Result<void>::ok();
 }
-cc::utils::Result<void> Server::attachMacros_to_one_meal(nlohmann::json& meal) {
-  double protein_quantity_in_gram = 0;
-  double carbs_quantity_in_gram = 0;
-  double fat_quantity_in_gram = 0;
-  for (auto food_dic : meal.at("foodItems")) {
-    cc::utils::Result<cc::models::Food> food_result =
-        this->foodService_->getOrFetchByBarcode(food_dic[0].get<std::string>());
-    if (food_result) {
-      cc::models::Food food = food_result.unwrap();
-
-      for (cc::models::Nutrient n : food.nutrients()) {
-        if (n.type() == cc::models::NutrientType::Protein) {
-          protein_quantity_in_gram += n.value();
-        } else if (n.type() == cc::models::NutrientType::Carbs) {
-          carbs_quantity_in_gram += n.value();
-        } else if (n.type() == cc::models::NutrientType::Fat) {
-          fat_quantity_in_gram += n.value();
-        }
-      }
 
+crow::response Server::lookupBarcodes(
+    const std::vector<std::string>& barcodes) {
+  constexpr std::size_t MAX_BARCODES = 500;
+  crow::json::wvalue response_json;
+  if (barcodes.empty()) {
+    response_json["error"] = "missed barcodes";
+    return crow::response(404, response_json);
+  }
+  if (barcodes.size() > MAX_BARCODES) {
+    response_json["error"] =
+        std::format("too many barcodes (max {})", MAX_BARCODES);
+    return crow::response(400, response_json);
+  }
+
+  auto results = this->foodService_->getOrFetchMany(barcodes);
+  cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+  cc::utils::JsonWriter w(64 + barcodes.size() * 448);
+  w.beginObject();
+  w.field("count", barcodes.size());
+  w.key("results").beginArray();
+  int found = 0;
+  for (std::size_t i = 0; i < barcodes.size(); i++) {
+    w.beginObject();
+    w.field("barcode", barcodes[i]);
+    if (results[i]) {
+      found++;
+      w.field("status", 200);
+      w.key("food");
+      cc::utils::writeJson(w, results[i].unwrap());
     } else {
-      return cc::utils::Result<void>::fail(food_result.unwrap_error().code,
-                                           food_result.unwrap_error().message);
+      w.field("status", cc::utils::convert_error_code_into_HTTP_Responses(
+                            results[i].unwrap_error().code));
+      w.field("error", results[i].unwrap_error().message);
     }
+    w.endObject();
   }
-  meal[magic_enum::enum_name(cc::models::NutrientType::Protein)] =
-      std::round(protein_quantity_in_gram);
-  meal[magic_enum::enum_name(cc::models::NutrientType::Carbs)] =
-      std::round(carbs_quantity_in_gram);
-  meal[magic_enum::enum_name(cc::models::NutrientType::Fat)] =
-      std::round(fat_quantity_in_gram);
-  return cc::utils::Result<void>::ok();
+  w.endArray();
+  w.field("found", found);
+  w.endObject();
+  return cc::utils::json_response(200, w.take());
 }
 
-cc::utils::Result<void> Server::attachMacros_to_meals(nlohmann::json& meals) {
-  for (auto& meal : meals) {
-    attachMacros_to_one_meal(meal);
+crow::response Server::runBatch(const crow::request& req) {
+  constexpr std::size_t MAX_OPERATIONS = 100;
+  crow::json::wvalue response_json;
+  nlohmann::json ops = [&] {
+    cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Parse);
+    return nlohmann::json::parse(req.body, nullptr, false);
+  }();
+  if (ops.is_discarded() || !ops.is_array()) {
+    response_json["error"] = "body must be an array of operations";
+    return crow::response(400, response_json);
+  }
+  if (ops.size() > MAX_OPERATIONS) {
+    response_json["error"] =
+        std::format("too many operations (max {})", MAX_OPERATIONS);
+    return crow::response(400, response_json);
   }
 
-  return cc::utils::Result<void>::ok();
+  // one sub response per operation, filled in by the phases below
+  struct Outcome {
+    int status = 0;
+    std::string body;  // JSON text
+  };
+  std::vector<Outcome> outcomes(ops.size());
+  auto fail = [&outcomes](std::size_t i, int status, std::string_view message) {
+    cc::utils::JsonWriter w;
+    w.beginObject().field("error", message).endObject();
+    outcomes[i] = {status, w.take()};
+  };
+  auto added = [&outcomes](std::size_t i) {
+    outcomes[i] = {200, R"({"status":"item was added"})"};
+  };
+
+  // consecutive operations of one kind run as a group, new foods and meals
+  // with one write per repository and reads concurrently; groups run in
+  // operation order so every operation sees the ones before it
+  enum class Kind { Food, Meal, Write, Read };
+  struct Step {
+    Kind kind;
+    std::size_t op;
+    std::size_t item = 0;  // index in foods or meals
+    crow::request sub;     // sub request run through the router
+  };
+  std::vector<Step> steps;
+  std::vector<cc::models::Food> foods;
+  std::vector<cc::models::MealLog> meals;
+  for (std::size_t i = 0; i < ops.size(); i++) {
+    const auto& op = ops[i];
+    auto text = [&op](const char* key, const char* fallback) -> std::string {
+      if (!op.is_object() || !op.contains(key)) return fallback;
+      return op[key].is_string() ? op[key].get<std::string>() : "";
+    };
+    const std::string method = text("method", "GET");
+    const std::string path = text("path", "");
+    if (!path.starts_with('/') || path.starts_with("/batch")) {
+      fail(i, 400, "operation needs a method and a route path");
+      continue;
+    }
+    // exports are sent from a file, they have no body to embed
+    if (path.starts_with("/export/")) {
+      fail(i, 400, "exports can't run in a batch");
+      continue;
+    }
+    const nlohmann::json body = op.value("body", nlohmann::json{});
+    if (method == "POST" && path == "/foods") {
+      auto food = cc::utils::foodFromRecord(body);
+      if (!food) {
+        fail(i, 400, food.unwrap_error().message);
+        continue;
+      }
+      steps.push_back({Kind::Food, i, foods.size(), {}});
+      foods.push_back(food.unwrap());
+      continue;
+    }
+    if (method == "POST" && path == "/meals") {
+      auto meal = cc::utils::mealFromRecord(body);
+      if (!meal) {
+        fail(i, 400, meal.unwrap_error().message);
+        continue;
+      }
+      steps.push_back({Kind::Meal, i, meals.size(), {}});
+      meals.push_back(meal.unwrap());
+      continue;
+    }
+
+    crow::request sub;
+    if (method == "GET") {
+      sub.method = crow::HTTPMethod::Get;
+    } else if (method == "POST") {
+      sub.method = crow::HTTPMethod::Post;
+    } else if (method == "PUT") {
+      sub.method = crow::HTTPMethod::Put;
+    } else if (method == "DELETE") {
+      sub.method = crow::HTTPMethod::Delete;
+    } else {
+      fail(i, 405, "method must be GET, POST, PUT or DELETE");
+      continue;
+    }
+    sub.raw_url = path;
+    sub.url = path.substr(0, path.find('?'));
+    sub.url_params = crow::query_string(path);
+    // the route limits count the operation against the batch's client
+    sub.remote_ip_address = req.remote_ip_address;
+    if (const auto& forwarded = req.get_header_value("X-Forwarded-For");
+        !forwarded.empty()) {
+      sub.add_header("X-Forwarded-For", forwarded);
+    }
+    if (!body.is_null()) sub.body = body.dump();
+    steps.push_back(
+        {method == "GET" ? Kind::Read : Kind::Write, i, 0, std::move(sub)});
+  }
+
+  // the outcome of a group committed with one write
+  auto settle = [&](std::span<const Step> group,
+                    const cc::utils::Result<void>& res) {
+    for (const auto& step : group) {
+      if (res) {
+        added(step.op);
+      } else {
+        fail(step.op, cc::utils::convert_error_code_into_HTTP_Responses(
+                          res.unwrap_error().code),
+             res.unwrap_error().message);
+      }
+    }
+  };
+  // handle_full skips the middleware, so the scan routes' limits are
+  // applied here, once per operation
+  auto& limits = this->app.get_middleware<middleware::RateLimit>();
+  auto dispatch = [this, &outcomes, &limits](Step& step) {
+    crow::response res;
+    middleware::RateLimit::context limit_ctx;
+    if (limits.admitRoute(step.sub, res, limit_ctx)) {
+      this->app.handle_full(step.sub, res);
+      limits.after_handle(step.sub, res, limit_ctx);
+    }
+    // plain text bodies (e.g. "invalid Json body") are wrapped as strings
+    if (res.get_header_value("Content-Type").starts_with("application/json")) {
+      outcomes[step.op] = {res.code, std::move(res.body)};
+    } else {
+      cc::utils::JsonWriter w;
+      w.value(res.body);
+      outcomes[step.op] = {res.code, w.take()};
+    }
+  };
+  for (std::size_t begin = 0; begin < steps.size();) {
+    const Kind kind = steps[begin].kind;
+    std::size_t end = begin + 1;
+    if (kind != Kind::Write) {
+      while (end < steps.size() && steps[end].kind == kind) end++;
+    }
+    std::span<Step> group(steps.data() + begin, end - begin);
+    switch (kind) {
+      case Kind::Food:
+        // POST /foods keeps a stored food as it is, so does the batch
+        settle(group, this->foodService_->addManualFoods(std::span(foods).subspan(
+                          group.front().item, group.size())));
+        break;
+      case Kind::Meal:
+        settle(group, this->mealService_->importMeals(std::span(meals).subspan(
+                          group.front().item, group.size())));
+        break;
+      case Kind::Write:
+        dispatch(group.front());
+        break;
+      case Kind::Read:
+        // reads are independent, they run concurrently on the shared pool
+        cc::utils::ThreadPool::shared().parallelFor(
+            group.size(), 1, [&](std::size_t first, std::size_t last) {
+              for (std::size_t r = first; r < last; r++) dispatch(group[r]);
+            });
+        break;
+    }
+    begin = end;
+  }
+
+  cc::utils::JsonWriter w(64);
+  w.beginArray();
+  for (const auto& outcome : outcomes) {
+    w.beginObject();
+    w.field("status", outcome.status);
+    w.key("body");
+    if (outcome.body.empty()) {
+      w.null();
+    } else {
+      w.raw(outcome.body);
+    }
+    w.endObject();
+  }
+  w.endArray();
+  return cc::utils::json_response(200, w.take());
 }
 
 void Server::setupRoutes() {
@@ -108,13 +599,23 @@ void Server::setupRoutes() {
         auto limit = req.url_params.get("limit");
         int offset_value = offset ? std::atoi(offset) : 0;
         int limit_value = limit ? std::atoi(limit) : 50;
+        // read before the data so a concurrent write can only make it stale
+        const std::string etag =
+            std::format("\"f{}\"", this->foodService_->version());
+        if (etagMatches(req, etag)) return notModified(etag);
         cc::utils::Result<std::vector<cc::models::Food>> list_of_food =
             this->foodService_->listFoods(offset_value, limit_value);
         crow::json::wvalue response_json;
         if (list_of_food) {
-          nlohmann::json list_of_food_json = list_of_food.unwrap();
-          response_json = cc::utils::to_crow_json(list_of_food_json);
-          return crow::response(200, response_json);
+          const auto& foods = list_of_food.unwrap();
+          cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+          cc::utils::JsonWriter w(64 + foods.size() * 384);
+          w.beginArray();
+          for (const auto& food : foods) {
+            cc::utils::writeJson(w, food);
+          }
+          w.endArray();
+          return withEtag(cc::utils::json_response(200, w.take()), etag);
         } else {
           response_json["error"] = list_of_food.unwrap_error().message;
           return crow::response(
@@ -136,9 +637,10 @@ void Server::setupRoutes() {
             this->foodService_->getOrFetchByBarcode(barcode);
 
         if (founded_food) {
-          nlohmann::json founded_food_json = founded_food.unwrap();
-          response_json = cc::utils::to_crow_json(founded_food_json);
-          return crow::response(200, response_json);
+          cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+          cc::utils::JsonWriter w;
+          cc::utils::writeJson(w, founded_food.unwrap());
+          return cc::utils::json_response(200, w.take());
         } else {
           response_json["error"] = founded_food.unwrap_error().message;
           return crow::response(
@@ -148,6 +650,65 @@ void Server::setupRoutes() {
         }
       });
 
+  // GET /foods/by_barcodes?barcodes=a,b,c
+  CROW_ROUTE(this->app, "/foods/by_barcodes")
+      .methods(crow::HTTPMethod::Get)([this](const crow::request& req) {
+        auto barcodes = req.url_params.get("barcodes");
+        return this->lookupBarcodes(
+            cc::utils::split(barcodes ? barcodes : "", ','));
+      });
+
+  // POST /foods/by_barcodes  {"barcodes": ["a", "b", "c"]} for long lists
+  CROW_ROUTE(this->app, "/foods/by_barcodes")
+      .methods(crow::HTTPMethod::POST)([this](const crow::request& req) {
+        auto body = loadBody(req);
+        if (!body || !body.has("barcodes")) {
+          return crow::response(400, "invalid Json body");
+        }
+        crow::json::wvalue response_json;
+        const auto& list = body["barcodes"];
+        if (list.t() != crow::json::type::List || list.size() == 0) {
+          response_json["error"] = "barcodes must be a non empty array";
+          return crow::response(400, response_json);
+        }
+        std::vector<std::string> barcodes;
+        for (const auto& b : list) {
+          if (b.t() != crow::json::type::String) {
+            response_json["error"] = "barcodes must be strings";
+            return crow::response(400, response_json);
+          }
+          if (!std::string(b.s()).empty()) barcodes.push_back(b.s());
+        }
+        if (barcodes.empty()) {
+          response_json["error"] = "barcodes are all empty";
+          return crow::response(400, response_json);
+        }
+        return this->lookupBarcodes(barcodes);
+      });
+
+  // GET /foods/usage?barcode=123 -> ids of the meals that use the food
+  CROW_ROUTE(this->app, "/foods/usage")
+      .methods(crow::HTTPMethod::GET)([this](const crow::request& req) {
+        auto barcode = req.url_params.get("barcode");
+        crow::json::wvalue response_json;
+        if (barcode == nullptr || std::string(barcode).empty()) {
+          response_json["error"] = "missed barcode";
+          return crow::response(404, response_json);
+        }
+        std::vector<int> meal_ids = this->mealService_->mealsUsingFood(barcode);
+        cc::utils::JsonWriter w(64 + meal_ids.size() * 8);
+        w.beginObject();
+        w.field("barcode", barcode);
+        w.field("count", meal_ids.size());
+        w.key("mealIds").beginArray();
+        for (int id : meal_ids) {
+          w.value(id);
+        }
+        w.endArray();
+        w.endObject();
+        return cc::utils::json_response(200, w.take());
+      });
+
   CROW_ROUTE(this->app, "/foods")
       .methods(crow::HTTPMethod::DELETE)([this](const crow::request& req) {
         crow::json::wvalue response_json;
@@ -193,7 +754,7 @@ void Server::setupRoutes() {
 
   CROW_ROUTE(this->app, "/foods")
       .methods(crow::HTTPMethod::POST)([this](const crow::request& req) {
-        auto body = crow::json::load(req.body);
+        auto body = loadBody(req);
         if (!body) {
           return crow::response(400, "invalid Json body");
         }
@@ -242,7 +803,7 @@ void Server::setupRoutes() {
       });
   CROW_ROUTE(this->app, "/foods")
       .methods(crow::HTTPMethod::PUT)([this](const crow::request& req) {
-        auto body = crow::json::load(req.body);
+        auto body = loadBody(req);
         if (!body) {
           return crow::response(400, "invalid Json body");
         }
@@ -286,6 +847,19 @@ void Server::setupRoutes() {
         }
       });
 
+  // POST /foods/bulk  (application/x-ndjson, one POST /foods body per line)
+  // -> {lines, imported, failed, batches, elapsedMs, recordsPerSecond,
+  //     errors: [{line, error}]}; existing ids are updated
+  CROW_ROUTE(this->app, "/foods/bulk")
+      .methods(crow::HTTPMethod::POST)([this](const crow::request& req) {
+        auto report = cc::utils::importNdjson<cc::models::Food>(
+            req.body, IMPORT_BATCH_SIZE, cc::utils::foodFromRecord,
+            [this](std::span<const cc::models::Food> foods) {
+              return this->foodService_->importFoods(foods);
+            });
+        return importResponse(report);
+      });
+
   ///////////////////////Meals//////////////////////////
 
   // GET /meals?offset=0&limit=50
@@ -297,19 +871,20 @@ void Server::setupRoutes() {
         int offset_value = offset ? std::atoi(offset) : 0;
         int limit_value = limit ? std::atoi(limit) : 50;
 
+        // meals without stored nutrition are enriched from the foods, so
+        // both versions make up the tag
+        const std::string etag =
+            std::format("\"m{}-f{}\"", this->mealService_->version(),
+                        this->foodService_->version());
+        if (etagMatches(req, etag)) return notModified(etag);
+
         auto res = this->mealService_->listMeals(offset_value, limit_value);
 
         crow::json::wvalue response_json;
         if (res) {
-          nlohmann::json j = res.unwrap();  // vector<MealLog> -> json (to_json)
-          if (!j.empty()) {
-            for (auto& item : j) {
-              this->calculateCalories(item);
-            }
-            attachMacros_to_meals(j);
-          }
-          response_json = cc::utils::to_crow_json(j);
-          return crow::response(200, response_json);
+          auto meals = res.unwrap();
+          this->enrichMeals(meals);
+          return withEtag(mealsResponse(meals), etag);
         } else {
           response_json["error"] = res.unwrap_error().message;
           return crow::response(
@@ -333,15 +908,9 @@ void Server::setupRoutes() {
         auto res = this->mealService_->getByName(std::string(name));
 
         if (res) {
-          nlohmann::json j = res.unwrap();
-          if (!j.empty()) {
-            for (auto& item : j) {
-              this->calculateCalories(item);
-            }
-            attachMacros_to_meals(j);
-          }
-          response_json = cc::utils::to_crow_json(j);
-          return crow::response(200, response_json);
+          auto meals = res.unwrap();
+          this->enrichMeals(meals);
+          return mealsResponse(meals);
         } else {
           response_json["error"] = res.unwrap_error().message;
           return crow::response(
@@ -366,11 +935,12 @@ void Server::setupRoutes() {
         auto res = this->mealService_->getById(meal_id);
 
         if (res) {
-          nlohmann::json j = res.unwrap();
-          attachMacros_to_one_meal(j);
-          this->calculateCalories(j);
-          response_json = cc::utils::to_crow_json(j);
-          return crow::response(200, response_json);
+          std::vector<cc::models::MealLog> meals{res.unwrap()};
+          this->enrichMeals(meals);
+          cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+          cc::utils::JsonWriter w;
+          cc::utils::writeJson(w, meals.front());
+          return cc::utils::json_response(200, w.take());
         } else {
           response_json["error"] = res.unwrap_error().message;
           return crow::response(
@@ -401,15 +971,9 @@ void Server::setupRoutes() {
         auto res = this->mealService_->getByDate(day, month, year);
 
         if (res) {
-          nlohmann::json j = res.unwrap();
-          if (!j.empty()) {
-            for (auto& item : j) {
-              this->calculateCalories(item);
-            }
-            attachMacros_to_meals(j);
-          }
-          response_json = cc::utils::to_crow_json(j);
-          return crow::response(200, response_json);
+          auto meals = res.unwrap();
+          this->enrichMeals(meals);
+          return mealsResponse(meals);
         } else {
           response_json["error"] = res.unwrap_error().message;
           return crow::response(
@@ -430,97 +994,41 @@ void Server::setupRoutes() {
           return crow::response(400, response_json);
         }
 
-        std::string fromStr(fromp);
-        std::string toStr(top);
-
-        auto validYmd = [](const std::string& s) {
-          return s.size() == 10 && s[4] == '-' && s[7] == '-';
-        };
-
-        if (!validYmd(fromStr) || !validYmd(toStr)) {
-          response_json["error"] = "wrong date format (use YYYY-MM-DD)";
-          return crow::response(400, response_json);
-        }
-
-        int fy = std::atoi(fromStr.substr(0, 4).c_str());
-        int fm = std::atoi(fromStr.substr(5, 2).c_str());
-        int fd = std::atoi(fromStr.substr(8, 2).c_str());
-
-        int ty = std::atoi(toStr.substr(0, 4).c_str());
-        int tm = std::atoi(toStr.substr(5, 2).c_str());
-        int td = std::atoi(toStr.substr(8, 2).c_str());
-
-        std::chrono::year_month_day fromYmd{
-            std::chrono::year{fy},
-            std::chrono::month{static_cast<unsigned>(fm)},
-            std::chrono::day{static_cast<unsigned>(fd)}};
-
-        std::chrono::year_month_day toYmd{
-            std::chrono::year{ty},
-            std::chrono::month{static_cast<unsigned>(tm)},
-            std::chrono::day{static_cast<unsigned>(td)}};
-
-        if (!fromYmd.ok() || !toYmd.ok()) {
-          response_json["error"] = "invalid date values";
-          return crow::response(400, response_json);
-        }
-
-        auto fromDay = std::chrono::sys_days{fromYmd};
-        auto toDay = std::chrono::sys_days{toYmd};
-
-        if (fromDay > toDay) {
-          response_json["error"] = "invalid range: from > to";
+        auto range = cc::utils::parseDayRange(fromp, top);
+        if (!range) {
+          response_json["error"] = range.unwrap_error().message;
           return crow::response(400, response_json);
         }
-
-        constexpr int BIG_LIMIT = 100000;
-        auto res = this->mealService_->listMeals(0, BIG_LIMIT);
-
-        if (!res) {
-          response_json["error"] = res.unwrap_error().message;
+        const auto [fromDay, toDay] = range.unwrap();
+
+        // meals are read, enriched and written a batch at a time, so only
+        // one batch of decoded meals is held besides the response text
+        constexpr std::size_t MEALS_PER_BATCH = 256;
+        cc::utils::JsonWriter w(64 + MEALS_PER_BATCH * 320);
+        w.beginArray();
+        cc::utils::Result<void> enrichRes = cc::utils::Result<void>::ok();
+        auto res = this->mealService_->scanMeals(
+            fromDay, toDay, MEALS_PER_BATCH,
+            [&](std::span<cc::models::MealLog> batch) {
+              // enrich with calories + macros like the list endpoints
+              enrichRes = this->enrichMeals(batch);
+              if (!enrichRes) return false;
+              cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+              for (const auto& meal : batch) {
+                cc::utils::writeJson(w, meal);
+              }
+              return true;
+            });
+        if (!res || !enrichRes) {
+          const auto& error =
+              res ? enrichRes.unwrap_error() : res.unwrap_error();
+          response_json["error"] = error.message;
           return crow::response(
-              cc::utils::convert_error_code_into_HTTP_Responses(
-                  res.unwrap_error().code),
+              cc::utils::convert_error_code_into_HTTP_Responses(error.code),
               response_json);
         }
-
-        nlohmann::json allMeals =
-            res.unwrap();  // array of MealLog JSON objects
-        nlohmann::json filtered = nlohmann::json::array();
-
-        for (auto& meal : allMeals) {
-          // your schema always has tsUtc, but keep it safe
-          if (!meal.contains("tsUtc")) continue;
-
-          auto tp = cc::utils::fromIso8601(meal["tsUtc"].get<std::string>());
-          auto day = std::chrono::floor<std::chrono::days>(tp);
-
-          if (day >= fromDay && day <= toDay) {
-            // enrich with calories + macros like your list endpoint
-            auto calRes = this->calculateCalories(meal);
-            if (!calRes) {
-              response_json["error"] = calRes.unwrap_error().message;
-              return crow::response(
-                  cc::utils::convert_error_code_into_HTTP_Responses(
-                      calRes.unwrap_error().code),
-                  response_json);
-            }
-
-            auto macRes = this->attachMacros_to_one_meal(meal);
-            if (!macRes) {
-              response_json["error"] = macRes.unwrap_error().message;
-              return crow::response(
-                  cc::utils::convert_error_code_into_HTTP_Responses(
-                      macRes.unwrap_error().code),
-                  response_json);
-            }
-
-            filtered.push_back(meal);
-          }
-        }
-
-        response_json = cc::utils::to_crow_json(filtered);
-        return crow::response(200, response_json);
+        w.endArray();
+        return cc::utils::json_response(200, w.take());
       });
 
   // POST /meals
@@ -532,7 +1040,7 @@ void Server::setupRoutes() {
   // }
   CROW_ROUTE(this->app, "/meals")
       .methods(crow::HTTPMethod::POST)([this](const crow::request& req) {
-        auto body = crow::json::load(req.body);
+        auto body = loadBody(req);
         if (!body) return crow::response(400, "invalid Json body");
 
         cc::models::MealLog meal;
@@ -581,6 +1089,18 @@ void Server::setupRoutes() {
         }
       });
 
+  // POST /meals/bulk  (application/x-ndjson, one POST /meals body per line)
+  // -> same report as /foods/bulk
+  CROW_ROUTE(this->app, "/meals/bulk")
+      .methods(crow::HTTPMethod::POST)([this](const crow::request& req) {
+        auto report = cc::utils::importNdjson<cc::models::MealLog>(
+            req.body, IMPORT_BATCH_SIZE, cc::utils::mealFromRecord,
+            [this](std::span<const cc::models::MealLog> meals) {
+              return this->mealService_->importMeals(meals);
+            });
+        return importResponse(report);
+      });
+
   // PUT /meals  (update)
   // Body example:
   // {
@@ -591,7 +1111,7 @@ void Server::setupRoutes() {
   // }
   CROW_ROUTE(this->app, "/meals")
       .methods(crow::HTTPMethod::PUT)([this](const crow::request& req) {
-        auto body = crow::json::load(req.body);
+        auto body = loadBody(req);
         if (!body) return crow::response(400, "invalid Json body");
 
         if (!body.has("id")) return crow::response(400, "missing field: id");
@@ -684,6 +1204,94 @@ void Server::setupRoutes() {
         }
       });
 
+  // POST /batch with [{"method": "POST", "path": "/meals", "body": {...}},
+  //                   {"method": "GET", "path": "/stats/day?day=2&month=2&year=2026"}]
+  // -> [{"status": 200, "body": ...}, ...] in the order of the operations
+  CROW_ROUTE(this->app, "/batch")
+      .methods(crow::HTTPMethod::POST)(
+          [this](const crow::request& req) { return this->runBatch(req); });
+
+  ///////////////////////Export//////////////////////////
+
+  // GET /export/foods?format=ndjson|csv -> every food, one per line; read
+  // from the data base and written to the export file a batch at a time
+  CROW_ROUTE(this->app, "/export/foods")
+      .methods(crow::HTTPMethod::GET)([this](const crow::request& req) {
+        crow::json::wvalue response_json;
+        auto f = req.url_params.get("format");
+        auto format = cc::utils::parseExportFormat(f ? f : "");
+        if (!format) {
+          response_json["error"] = "format must be ndjson or csv";
+          return crow::response(400, response_json);
+        }
+        ExportFile file = openExport("foods");
+        cc::utils::JsonWriter w;
+        cc::utils::appendFoodHeader(file.buffer, *format);
+        auto res = this->foodService_->scanFoods(
+            EXPORT_BATCH_SIZE, [&](std::span<cc::models::Food> foods) {
+              cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+              for (const auto& food : foods) {
+                cc::utils::appendFood(file.buffer, w, food, *format);
+              }
+              return file.flush();
+            });
+        if (!res) {
+          std::error_code ec;
+          std::filesystem::remove(file.path, ec);
+          response_json["error"] = res.unwrap_error().message;
+          return crow::response(
+              cc::utils::convert_error_code_into_HTTP_Responses(
+                  res.unwrap_error().code),
+              response_json);
+        }
+        return exportResponse(*format, "foods", file);
+      });
+
+  // GET /export/meals?format=ndjson|csv&enrich=true -> every meal, one per
+  // line; enrich computes the totals of meals stored without them (and adds
+  // the nutrition columns to CSV)
+  CROW_ROUTE(this->app, "/export/meals")
+      .methods(crow::HTTPMethod::GET)([this](const crow::request& req) {
+        crow::json::wvalue response_json;
+        auto f = req.url_params.get("format");
+        auto format = cc::utils::parseExportFormat(f ? f : "");
+        if (!format) {
+          response_json["error"] = "format must be ndjson or csv";
+          return crow::response(400, response_json);
+        }
+        auto e = req.url_params.get("enrich");
+        const bool enrich =
+            e && (std::string_view(e) == "true" || std::string_view(e) == "1");
+
+        ExportFile file = openExport("meals");
+        cc::utils::JsonWriter w;
+        cc::utils::appendMealHeader(file.buffer, *format, enrich);
+        cc::utils::Result<void> enrichRes = cc::utils::Result<void>::ok();
+        auto res = this->mealService_->scanMeals(
+            EXPORT_BATCH_SIZE, [&](std::span<cc::models::MealLog> meals) {
+              if (enrich) {
+                enrichRes = this->enrichMeals(meals);
+                if (!enrichRes) return false;
+              }
+              cc::utils::PhaseTimer phase(cc::utils::TimingPhase::Serialize);
+              for (const auto& meal : meals) {
+                cc::utils::appendMeal(file.buffer, w, meal, *format, enrich);
+              }
+              return file.flush();
+            });
+        if (!res || !enrichRes) {
+          std::error_code ec;
+          std::filesystem::remove(file.path, ec);
+          const auto& error =
+              res ? enrichRes.unwrap_error() : res.unwrap_error();
+          response_json["error"] = error.message;
+          return crow::response(
+              cc::utils::convert_error_code_into_HTTP_Responses(error.code),
+              response_json);
+        }
+        return exportResponse(*format, "meals", file);
+      });
+
   CROW_ROUTE(this->app, "/stats/day")
       .methods(crow::HTTPMethod::GET)([this](const crow::request& req) {
         auto d = req.url_params.get("day");
@@ -700,7 +1308,9 @@ void Server::setupRoutes() {
         int month = std::atoi(m);
         int year = std::atoi(y);
 
-        auto res = this->mealService_->getByDate(day, month, year);
+        // O(1): maintained incrementally by MealService on every write
+        std::uint64_t version = 0;
+        auto res = this->mealService_->dailyTotals(day, month, year, &version);
         if (!res) {
           out["error"] = res.unwrap_error().message;
           return crow::response(
@@ -708,51 +1318,191 @@ void Server::setupRoutes() {
                   res.unwrap_error().code),
               out);
         }
+        // read with the totals, so a tag never names older totals
+        const std::string etag = std::format("\"d{}\"", version);
+        if (etagMatches(req, etag)) return notModified(etag);
+        const cc::services::DailyTotals& totals = res.unwrap();
+
+        cc::utils::JsonWriter w;
+        w.beginObject();
+        w.field("day", day);
+        w.field("month", month);
+        w.field("year", year);
+        w.field("mealsCount", totals.mealsCount);
+        w.field("pendingMeals", totals.pendingMeals);
+        w.field("totalCalories", (int)std::round(totals.totals.calories));
+        for (const auto& info : cc::models::NUTRIENTS) {
+          w.field(magic_enum::enum_name(info.type),
+                  (int)std::round(totals.totals[info.type]));
+        }
+        w.endObject();
+        return withEtag(cc::utils::json_response(200, w.take()), etag);
+      });
 
-        nlohmann::json meals = res.unwrap();
+  // GET /stats/range?from=2026-02-01&to=2026-02-28&granularity=day|week|month
+  CROW_ROUTE(this->app, "/stats/range")
+      .methods(crow::HTTPMethod::GET)([this](const crow::request& req) {
+        constexpr std::size_t MAX_PERIODS = 1000;
+        auto fromp = req.url_params.get("from");
+        auto top = req.url_params.get("to");
+        auto granularityp = req.url_params.get("granularity");
+        crow::json::wvalue out;
 
-        double totalCalories = 0.0;
-        double totalProtein = 0.0;
-        double totalCarbs = 0.0;
-        double totalFat = 0.0;
+        if (!fromp || !top) {
+          out["error"] = "missing from/to";
+          return crow::response(400, out);
+        }
+        auto range = cc::utils::parseDayRange(fromp, top);
+        if (!range) {
+          out["error"] = range.unwrap_error().message;
+          return crow::response(400, out);
+        }
+        const auto [fromDay, toDay] = range.unwrap();
+
+        const std::string granularity_str = granularityp ? granularityp : "day";
+        cc::services::Granularity granularity;
+        if (granularity_str == "day") {
+          granularity = cc::services::Granularity::Day;
+        } else if (granularity_str == "week") {
+          granularity = cc::services::Granularity::Week;
+        } else if (granularity_str == "month") {
+          granularity = cc::services::Granularity::Month;
+        } else {
+          out["error"] = "invalid granularity (use day, week or month)";
+          return crow::response(400, out);
+        }
+        // checked on the dates, before any period is built
+        if (cc::services::DailyAggregateStore::periodCount(
+                fromDay, toDay, granularity) > MAX_PERIODS) {
+          out["error"] = std::format("too many periods (max {})", MAX_PERIODS);
+          return crow::response(400, out);
+        }
 
-        for (auto& meal : meals) {
-          auto calRes = this->calculateCalories(meal);
-          if (!calRes) {
-            out["error"] = calRes.unwrap_error().message;
-            return crow::response(
-                cc::utils::convert_error_code_into_HTTP_Responses(
-                    calRes.unwrap_error().code),
-                out);
-          }
+        auto periods =
+            this->mealService_->periodTotals(fromDay, toDay, granularity);
+        cc::services::DailyTotals total;
+        for (const auto& period : periods) {
+          total += period.totals;
+        }
+        cc::utils::JsonWriter w(256 + periods.size() * 512);
+        w.beginObject();
+        w.field("granularity", granularity_str);
+        w.key("total");
+        writePeriod(w, fromDay, toDay, total);
+        w.endObject();
+        w.key("periods").beginArray();
+        for (const auto& period : periods) {
+          writePeriod(w, period.start, period.end, period.totals);
+          w.endObject();
+        }
+        w.endArray();
+        w.endObject();
+        return cc::utils::json_response(200, w.take());
+      });
 
-          auto macRes = this->attachMacros_to_one_meal(meal);
-          if (!macRes) {
-            out["error"] = macRes.unwrap_error().message;
-            return crow::response(
-                cc::utils::convert_error_code_into_HTTP_Responses(
-                    macRes.unwrap_error().code),
-                out);
-          }
+  // GET /stats/series?from=2025-01-01&to=2025-12-31&points=100
+  // daily kcal and macros downsampled to at most `points` buckets
+  CROW_ROUTE(this->app, "/stats/series")
+      .methods(crow::HTTPMethod::GET)([this](const crow::request& req) {
+        constexpr int DEFAULT_POINTS = 100;
+        constexpr int MAX_POINTS = 1000;
+        auto fromp = req.url_params.get("from");
+        auto top = req.url_params.get("to");
+        auto pointsp = req.url_params.get("points");
+        crow::json::wvalue out;
 
-          totalCalories += meal.value("calories", 0.0);
-          totalProtein += meal.value("Protein", 0.0);
-          totalCarbs += meal.value("Carbs", 0.0);
-          totalFat += meal.value("Fat", 0.0);
+        if (!fromp || !top) {
+          out["error"] = "missing from/to";
+          return crow::response(400, out);
+        }
+        auto range = cc::utils::parseDayRange(fromp, top);
+        if (!range) {
+          out["error"] = range.unwrap_error().message;
+          return crow::response(400, out);
+        }
+        const auto [fromDay, toDay] = range.unwrap();
+        const int points = pointsp ? std::atoi(pointsp) : DEFAULT_POINTS;
+        if (points <= 0 || points > MAX_POINTS) {
+          out["error"] = std::format("points must be between 1 and {}", MAX_POINTS);
+          return crow::response(400, out);
         }
 
-        out["day"] = day;
-        out["month"] = month;
-        out["year"] = year;
-        out["mealsCount"] = (int)meals.size();
-        out["totalCalories"] = (int)std::round(totalCalories);
-        out["Protein"] = (int)std::round(totalProtein);
-        out["Carbs"] = (int)std::round(totalCarbs);
-        out["Fat"] = (int)std::round(totalFat);
+        const auto series = this->mealService_->series(fromDay, toDay, points);
+        cc::utils::JsonWriter w(256 + series.size() * 512);
+        w.beginObject();
+        w.field("from", std::format("{:%F}", fromDay));
+        w.field("to", std::format("{:%F}", toDay));
+        w.field("points", series.size());
+        w.key("series").beginArray();
+        for (const auto& point : series) {
+          writePeriod(w, point.start, point.end, point.totals);
+          w.field("minCalories", (int)std::round(point.minCalories));
+          w.field("maxCalories", (int)std::round(point.maxCalories));
+          w.endObject();
+        }
+        w.endArray();
+        w.endObject();
+        return cc::utils::json_response(200, w.take());
+      });
 
+  // GET /stats/resolver -> background food resolver queue depth and lag
+  CROW_ROUTE(this->app, "/stats/resolver")
+      .methods(crow::HTTPMethod::GET)([this]() {
+        crow::json::wvalue out;
+        auto resolver = this->mealService_->foodResolver();
+        if (!resolver) {
+          out["error"] = "food resolver is not enabled";
+          return crow::response(404, out);
+        }
+        auto stats = resolver->stats();
+        out["queueDepth"] = stats.queueDepth;
+        out["lagMs"] = stats.lagMs;
+        out["lastWaitMs"] = stats.lastWaitMs;
+        out["resolved"] = stats.resolved;
+        out["failed"] = stats.failed;
         return crow::response(200, out);
       });
 
+  // GET /stats/cache -> decoded food cache usage and hit/miss/eviction counters,
+  // plus the compressed body cache
+  CROW_ROUTE(this->app, "/stats/cache")
+      .methods(crow::HTTPMethod::GET)([this]() {
+        crow::json::wvalue out;
+        auto stats = this->foodService_->cacheStats();
+        out["policy"] = stats.policy;
+        out["entries"] = stats.entries;
+        out["bytes"] = stats.bytes;
+        out["budgetBytes"] = stats.budgetBytes;
+        out["hits"] = stats.hits;
+        out["misses"] = stats.misses;
+        out["evictions"] = stats.evictions;
+        out["invalidations"] = stats.invalidations;
+        const auto lookups = stats.hits + stats.misses;
+        out["hitRatio"] = lookups ? double(stats.hits) / double(lookups) : 0.0;
+        // compressed response bodies
+        auto bodies =
+            this->app.get_middleware<CompressionMiddleware>().cacheStats();
+        out["compression"]["entries"] = bodies.entries;
+        out["compression"]["bytes"] = bodies.bytes;
+        out["compression"]["budgetBytes"] = bodies.budgetBytes;
+        out["compression"]["hits"] = bodies.hits;
+        out["compression"]["misses"] = bodies.misses;
+        return crow::response(200, out);
+      });
+
+  // GET /metrics -> every counter, gauge and histogram in Prometheus text
+  // format: requests, storage, OpenFoodFacts, caches, queues
+  CROW_ROUTE(this->app, "/metrics")
+      .methods(crow::HTTPMethod::GET)([this]() {
+        std::string body;
+        body.reserve(64 * 1024);
+        cc::utils::MetricsRegistry::global().render(body);
+        this->metrics_.render(body);
+        crow::response res(200, std::move(body));
+        res.set_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+        return res;
+      });
+
   ///////////////////////Meals//////////////////////////
 }
 void Server::start() {
@@ -764,13 +1514,26 @@ void Server::start() {
         running_ = true;
       }
       cv_.notify_one();
-      this->app.port(this->port_).multithreaded().run();
+      // Crow starts its threads from this one, they inherit the cpu set
+      if (!this->threads_.cpus.empty()) {
+        auto pinned = cc::utils::pinCurrentThread(this->threads_.cpus);
+        if (!pinned) {
+          std::cerr << "server: " << pinned.unwrap_error().message << std::endl;
+        }
+      }
+      this->app.port(this->port_)
+          .concurrency(cc::utils::httpThreads(this->threads_))
+          .run();
     });
     // wait until thread reached the "running" point
     std::unique_lock<std::mutex> lk(m_);
     cv_.wait(lk, [this] { return running_; });
     // now wait until port is actually listening
     cc::utils::waitUntilListening(this->port_, std::chrono::milliseconds{2000});
+    std::cout << "listening on port " << this->port_ << "\n"
+              << cc::utils::describeLayout(
+                     this->threads_, cc::utils::ThreadPool::shared().size())
+              << std::flush;
   } catch (std::exception& e) {
     std::cerr << "Server thread exception" << e.what() << std::endl;
     std::terminate();
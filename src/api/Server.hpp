@@ -2,15 +2,22 @@
 #include <cstdint>
 #include <memory>
 
+#include "api/CompressionMiddleware.hpp"
+#include "api/middleware/Metrics.hpp"
+#include "api/middleware/RateLimit.hpp"
+#include "api/middleware/RequestId.hpp"
 #include "services/FoodService.hpp"
 #include "services/MealService.hpp"
 #include "utils/Json_utils.hpp"
+#include "utils/Metrics.hpp"
 #include "utils/common_functions.hpp"
 #include "utils/Result.hpp"
+#include "utils/ThreadLayout.hpp"
 #include <crow.h>
 
 #include <cstdlib>
 #include <mutex>
+#include <span>
 #include <thread>
 
 namespace cc::services {
@@ -32,14 +39,36 @@ class Server {
     void setupRoutes();
     void start();
     void stop();
-    cc::utils::Result<void> attachMacros_to_meals(nlohmann::json& meals);
-    cc::utils::Result<void> attachMacros_to_one_meal(nlohmann::json& meal);
-    cc::utils::Result<void> calculateCalories(nlohmann::json& meal);
+    // fills in kcal and nutrients of the meals for a response: the foods of
+    // all meals without materialized nutrition are resolved once, then each
+    // meal is summed in a single pass (in parallel for large lists).
+    // Nutrients are rounded; the first failing meal (in order) wins
+    cc::utils::Result<void> enrichMeals(std::span<cc::models::MealLog> meals);
+    // threshold, level and cache of the gzip/deflate response compression
+    void configureCompression(const CompressionMiddleware::Options& options);
+    // per client and per route token buckets and in flight caps
+    void configureRateLimit(const middleware::RateLimit::Options& options);
+    // Crow worker count and the cpus its threads run on, read by start()
+    void configureThreads(const cc::utils::ThreadLayout& layout);
 
   private:
+    crow::response lookupBarcodes(const std::vector<std::string>& barcodes);
+    // POST /batch: new foods and meals are committed with one write per
+    // repository, other writes run one by one through the routes, then the
+    // reads run concurrently; results are in operation order
+    crow::response runBatch(const crow::request& req);
+    // gauges of this server's services and caches, read at each scrape
+    void registerMetrics();
+
     std::thread server_thread;
-    crow::SimpleApp app;
+    // after_handle runs in reverse order: RequestId and Metrics see the
+    // compression time, and the requests RateLimit refuses
+    crow::App<middleware::RequestId, middleware::Metrics, middleware::RateLimit,
+              CompressionMiddleware>
+        app;
     int port_;
+    cc::utils::ThreadLayout threads_;
+    cc::utils::MetricsRegistry metrics_;
     bool cors_ = false;
     std::shared_ptr<cc::services::FoodService> foodService_;
     std::shared_ptr<cc::services::MealService> mealService_;
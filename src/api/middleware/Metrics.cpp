@@ -0,0 +1,37 @@
+#include "api/middleware/Metrics.hpp"
+
+#include <string>
+
+namespace cc {
+namespace api::middleware {
+
+Metrics::Metrics()
+    : requests_{cc::utils::MetricsRegistry::global().counter(
+          "cc_http_requests_total", "HTTP requests by method, path and status",
+          {"method", "path", "status"})},
+      durations_{cc::utils::MetricsRegistry::global().histogram(
+          "cc_http_request_duration_seconds",
+          "Time from routing to the response, by method and path",
+          {"method", "path"})},
+      in_flight_{cc::utils::MetricsRegistry::global()
+                     .gauge("cc_http_requests_in_flight",
+                            "HTTP requests being handled")
+                     .get()} {}
+
+void Metrics::before_handle(crow::request&, crow::response&, context& ctx) {
+  ctx.start = std::chrono::steady_clock::now();
+  this->in_flight_.inc();
+}
+
+void Metrics::after_handle(crow::request& req, crow::response& res,
+                           context& ctx) {
+  this->in_flight_.dec();
+  const std::string method = crow::method_name(req.method);
+  // req.url has no query string, the routes take no path parameters
+  this->durations_.labels({method, req.url})
+      .observe(std::chrono::steady_clock::now() - ctx.start);
+  this->requests_.labels({method, req.url, std::to_string(res.code)}).inc();
+}
+
+} // namespace api::middleware
+} // namespace cc
@@ -0,0 +1,32 @@
+#pragma once
+#include <crow.h>
+
+#include <chrono>
+
+#include "utils/Metrics.hpp"
+
+namespace cc {
+namespace api::middleware {
+
+// Counts requests by method, path and status, their latency by method and
+// path, and the requests in flight, in the global metrics registry. Paths
+// past MAX_LABEL_SETS (e.g. a scan of unknown URLs) are folded into "other".
+class Metrics {
+  public:
+    struct context {
+        std::chrono::steady_clock::time_point start;
+    };
+
+    Metrics();
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+  private:
+    cc::utils::MetricFamily<cc::utils::Counter>& requests_;
+    cc::utils::MetricFamily<cc::utils::Histogram>& durations_;
+    cc::utils::Gauge& in_flight_;
+};
+
+} // namespace api::middleware
+} // namespace cc
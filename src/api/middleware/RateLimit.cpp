@@ -0,0 +1,167 @@
+#include "api/middleware/RateLimit.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <format>
+
+namespace cc {
+namespace api::middleware {
+
+RateLimit::RateLimit()
+    : rejected_{cc::utils::MetricsRegistry::global().counter(
+          "cc_http_rejected_total",
+          "Requests refused before their handler, by limit",
+          {"reason"})} {
+  this->configure(Options{});
+}
+
+std::unordered_map<std::string, RateLimit::RouteOptions>
+RateLimit::defaultRoutes() {
+  const RouteOptions scan{cc::utils::RateLimit{5, 10}, 4};
+  return {{"/meals/by_range", scan}, {"/export/meals", scan}};
+}
+
+void RateLimit::configure(const Options& options) {
+  this->options_ = options;
+  this->clients_ = std::make_unique<cc::utils::RateLimiter>(options.client);
+  this->routes_.clear();
+  for (const auto& [path, route] : options.routes) {
+    auto state = std::make_unique<Route>();
+    state->options = route;
+    state->limiter = std::make_unique<cc::utils::RateLimiter>(route.client);
+    this->routes_.emplace(path, std::move(state));
+  }
+}
+
+std::string RateLimit::clientOf(const crow::request& req) const {
+  if (this->options_.trustForwardedFor) {
+    const std::string& forwarded = req.get_header_value("X-Forwarded-For");
+    if (!forwarded.empty()) {
+      std::string_view first =
+          std::string_view(forwarded).substr(0, forwarded.find(','));
+      while (!first.empty() && first.back() == ' ') first.remove_suffix(1);
+      while (!first.empty() && first.front() == ' ') first.remove_prefix(1);
+      if (!first.empty()) return std::string(first);
+    }
+  }
+  return req.remote_ip_address;
+}
+
+void RateLimit::reject(crow::response& res, int code, std::string_view reason,
+                       cc::utils::RateLimiter::clock::duration retryAfter) {
+  this->rejected_.labels({reason}).inc();
+  // whole seconds, rounded up so a retry is not refused again
+  const auto seconds = std::max<long long>(
+      1, static_cast<long long>(std::ceil(
+             std::chrono::duration<double>(retryAfter).count())));
+  res.code = code;
+  res.set_header("Retry-After", std::to_string(seconds));
+  res.set_header("Content-Type", "application/json");
+  res.body = std::format("{{\"error\":\"{}\",\"retryAfter\":{}}}",
+                         code == 429 ? "too many requests" : "server busy",
+                         seconds);
+  res.end();
+}
+
+void RateLimit::before_handle(crow::request& req, crow::response& res,
+                              context& ctx) {
+  using namespace std::chrono_literals;
+  // load shedding first: it costs nothing and protects everyone
+  if (this->options_.maxInFlight > 0) {
+    if (this->in_flight_.fetch_add(1) >= this->options_.maxInFlight) {
+      this->in_flight_.fetch_sub(1);
+      return this->reject(res, 503, "overload", 1s);
+    }
+    ctx.inFlight = true;
+  }
+  if (this->options_.client.enabled()) {
+    auto decision = this->clients_->acquire(this->clientOf(req));
+    if (!decision.allowed) {
+      return this->reject(res, 429, "client_rate", decision.retryAfter);
+    }
+  }
+  this->admitRoute(req, res, ctx);
+}
+
+bool RateLimit::admitRoute(const crow::request& req, crow::response& res,
+                           context& ctx) {
+  using namespace std::chrono_literals;
+  auto route = this->routes_.find(req.url);
+  if (route == this->routes_.end()) return true;
+  Route& limits = *route->second;
+  if (limits.options.maxInFlight > 0) {
+    if (limits.inFlight.fetch_add(1) >= limits.options.maxInFlight) {
+      limits.inFlight.fetch_sub(1);
+      this->reject(res, 503, "route_overload", 1s);
+      return false;
+    }
+    ctx.routeInFlight = &limits.inFlight;
+  }
+  if (limits.options.client.enabled()) {
+    auto decision = limits.limiter->acquire(this->clientOf(req));
+    if (!decision.allowed) {
+      this->reject(res, 429, "route_rate", decision.retryAfter);
+      return false;
+    }
+  }
+  return true;
+}
+
+void RateLimit::after_handle(crow::request&, crow::response&, context& ctx) {
+  if (ctx.routeInFlight) {
+    ctx.routeInFlight->fetch_sub(1);
+    ctx.routeInFlight = nullptr;
+  }
+  if (ctx.inFlight) {
+    this->in_flight_.fetch_sub(1);
+    ctx.inFlight = false;
+  }
+}
+
+cc::utils::Result<std::unordered_map<std::string, RateLimit::RouteOptions>>
+parseRouteLimits(std::string_view text) {
+  using Routes = std::unordered_map<std::string, RateLimit::RouteOptions>;
+  Routes routes;
+  while (!text.empty()) {
+    const std::size_t comma = text.find(',');
+    std::string_view entry = text.substr(0, comma);
+    text = comma == std::string_view::npos ? std::string_view{}
+                                           : text.substr(comma + 1);
+    const std::size_t eq = entry.find('=');
+    if (eq == std::string_view::npos || eq == 0 || entry[0] != '/') {
+      return cc::utils::Result<Routes>::fail(
+          cc::utils::ErrorCode::InvalidInput,
+          "expected /path=rate[:burst[:maxInFlight]], got '" +
+              std::string(entry) + "'");
+    }
+    std::string_view spec = entry.substr(eq + 1);
+    RateLimit::RouteOptions route;
+    // the third field is the in flight cap, the rest a rate limit
+    const std::size_t first = spec.find(':');
+    const std::size_t second = first == std::string_view::npos
+                                   ? std::string_view::npos
+                                   : spec.find(':', first + 1);
+    if (second != std::string_view::npos) {
+      std::string_view cap = spec.substr(second + 1);
+      auto [ptr, ec] =
+          std::from_chars(cap.data(), cap.data() + cap.size(), route.maxInFlight);
+      if (ec != std::errc{} || ptr != cap.data() + cap.size()) {
+        return cc::utils::Result<Routes>::fail(
+            cc::utils::ErrorCode::InvalidInput,
+            "invalid in flight cap '" + std::string(cap) + "'");
+      }
+      spec = spec.substr(0, second);
+    }
+    auto limit = cc::utils::parseRateLimit(spec);
+    if (!limit) {
+      return cc::utils::Result<Routes>::fail(limit.unwrap_error().code,
+                                             limit.unwrap_error().message);
+    }
+    route.client = limit.unwrap();
+    routes[std::string(entry.substr(0, eq))] = route;
+  }
+  return cc::utils::Result<Routes>::ok(std::move(routes));
+}
+
+} // namespace api::middleware
+} // namespace cc
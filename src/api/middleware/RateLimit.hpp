@@ -0,0 +1,86 @@
+#pragma once
+#include <crow.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "utils/Metrics.hpp"
+#include "utils/RateLimiter.hpp"
+#include "utils/Result.hpp"
+
+namespace cc {
+namespace api::middleware {
+
+// Refuses requests over the limits before they reach a handler, instead of
+// letting them queue for a worker: 429 with Retry-After when a client's
+// token bucket (overall or for the route) is empty, 503 with Retry-After
+// when too many requests are being handled already.
+class RateLimit {
+  public:
+    struct RouteOptions {
+        // per client on this path
+        cc::utils::RateLimit client;
+        // requests of every client on this path at once, 0 = no cap
+        unsigned maxInFlight{0};
+    };
+
+    struct Options {
+        // per client over every path, off by default
+        cc::utils::RateLimit client;
+        // requests being handled at once, 0 = no cap
+        unsigned maxInFlight{0};
+        // by exact path; by default the full scans of the meals file
+        std::unordered_map<std::string, RouteOptions> routes = defaultRoutes();
+        // the client is the first X-Forwarded-For address, behind a proxy
+        bool trustForwardedFor{false};
+    };
+
+    struct context {
+        // the slots this request holds, released by after_handle
+        std::atomic<unsigned>* routeInFlight{nullptr};
+        bool inFlight{false};
+    };
+
+    RateLimit();
+
+    // replaces the limits and forgets every bucket; call before start()
+    void configure(const Options& options);
+    const Options& options() const { return this->options_; }
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+    // only the limits of the request's route, for the operations of /batch
+    // which reach their handlers without the middleware; false with res
+    // filled in when refused, otherwise release with after_handle
+    bool admitRoute(const crow::request& req, crow::response& res, context& ctx);
+
+    // /meals/by_range and /export/meals: 5 per second, bursts of 10, 4 at once
+    static std::unordered_map<std::string, RouteOptions> defaultRoutes();
+
+  private:
+    struct Route {
+        RouteOptions options;
+        std::unique_ptr<cc::utils::RateLimiter> limiter;
+        std::atomic<unsigned> inFlight{0};
+    };
+
+    std::string clientOf(const crow::request& req) const;
+    void reject(crow::response& res, int code, std::string_view reason,
+                cc::utils::RateLimiter::clock::duration retryAfter);
+
+    Options options_;
+    std::unique_ptr<cc::utils::RateLimiter> clients_;
+    std::unordered_map<std::string, std::unique_ptr<Route>> routes_;
+    std::atomic<unsigned> in_flight_{0};
+    cc::utils::MetricFamily<cc::utils::Counter>& rejected_;
+};
+
+// "/meals/by_range=5:10:4,/export/meals=1" -> path=rate[:burst[:maxInFlight]]
+cc::utils::Result<std::unordered_map<std::string, RateLimit::RouteOptions>> parseRouteLimits(
+    std::string_view text);
+
+} // namespace api::middleware
+} // namespace cc
@@ -0,0 +1,46 @@
+#include "api/middleware/RequestId.hpp"
+
+#include <cctype>
+#include <cstdint>
+#include <format>
+#include <random>
+
+namespace cc {
+namespace api::middleware {
+
+bool isValidRequestId(std::string_view id) {
+  if (id.empty() || id.size() > 128) return false;
+  for (char c : id) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' &&
+        c != '.' && c != ':') {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string newRequestId() {
+  thread_local std::mt19937_64 rng{std::random_device{}()};
+  return std::format("{:016x}", rng());
+}
+
+void RequestId::before_handle(crow::request& req, crow::response&,
+                              context& ctx) {
+  ctx.start = std::chrono::steady_clock::now();
+  const std::string& sent = req.get_header_value("X-Request-Id");
+  ctx.id = isValidRequestId(sent) ? sent : newRequestId();
+  // handlers run on this thread, their PhaseTimers record into ctx
+  cc::utils::bindRequestTimings(&ctx.timings);
+}
+
+void RequestId::after_handle(crow::request&, crow::response& res,
+                             context& ctx) {
+  cc::utils::bindRequestTimings(nullptr);
+  res.set_header("X-Request-Id", ctx.id);
+  res.set_header("Server-Timing",
+                 cc::utils::formatServerTiming(
+                     ctx.timings, std::chrono::steady_clock::now() - ctx.start));
+}
+
+} // namespace api::middleware
+} // namespace cc
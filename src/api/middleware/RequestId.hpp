@@ -1,9 +1,35 @@
 #pragma once
+#include <crow.h>
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "utils/RequestTiming.hpp"
 
 namespace cc {
 namespace api::middleware {
 
-// TODO: declare your classes/functions here
+// Tags every request with an X-Request-Id, the client's when it sends a
+// usable one, and reports where its time went in a Server-Timing header
+// (parse, storage, off, enrich, serialize, compress and total, in ms).
+// The phases are recorded by PhaseTimer scopes on the handling thread.
+class RequestId {
+  public:
+    struct context {
+        std::string id;
+        std::chrono::steady_clock::time_point start;
+        cc::utils::RequestTimings timings;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
+
+// up to 128 letters, digits and "-_.:", so the id is safe to log and echo
+bool isValidRequestId(std::string_view id);
+// 16 random hex digits
+std::string newRequestId();
 
 } // namespace api::middleware
 } // namespace cc
@@ -1,5 +1,7 @@
 #include "models/food.hpp"
 #include "models/nutrient.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/RequestTiming.hpp"
 #include "utils/Result.hpp"
 #include <algorithm>
 #include <array>
@@ -13,6 +15,15 @@
 #include <utils/common_functions.hpp>
 #include <vector>
 namespace cc::clients {
+namespace {
+// lookups by outcome: ok, invalid, network_error, parse_error
+cc::utils::Counter& offRequests(std::string_view result) {
+    static auto& family = cc::utils::MetricsRegistry::global().counter(
+        "cc_off_requests_total", "OpenFoodFacts product lookups by outcome", {"result"});
+    return family.labels({result});
+}
+} // namespace
+
 OpenFoodFactsClient::OpenFoodFactsClient(const std::string baseUrl, const std::string userAgent)
     : baseUrl_(baseUrl), userAgent_(userAgent) {
     this->locale = "en";
@@ -20,9 +31,16 @@ OpenFoodFactsClient::OpenFoodFactsClient(const std::string baseUrl, const std::s
 cc::utils::Result<cc::models::Food> OpenFoodFactsClient::getByBarcode(const std::string& barcode) {
 
     if (!(cc::utils::isBarCodeDigit(barcode))) {
+        offRequests("invalid").inc();
         return cc::utils::Result<cc::models::Food>::fail(cc::utils::ErrorCode::InvalidInput,
                                                          "barcode needs to be a number");
     }
+    cc::utils::PhaseTimer phase(cc::utils::TimingPhase::OffFetch);
+    static auto& duration = cc::utils::MetricsRegistry::global()
+                                .histogram("cc_off_request_duration_seconds",
+                                           "Time of the OpenFoodFacts product lookups")
+                                .get();
+    cc::utils::HistogramTimer timer{duration};
     if (curl_global_init(CURL_GLOBAL_DEFAULT) != 0) {
         std::cerr << "curl_global_init failed\n";
     }
@@ -40,15 +58,18 @@ cc::utils::Result<cc::models::Food> OpenFoodFactsClient::getByBarcode(const std:
         http.getJson(this->baseUrl_ + "/api/v2/product/{" + barcode + "}.json" + reduce_payload);
     if (!r) {
         std::cerr << "GET failed: " << r.unwrap_error().message << "\n";
+        offRequests("network_error").inc();
         return cc::utils::Result<cc::models::Food>::fail(cc::utils::ErrorCode::NetworkError,
                                                          r.unwrap_error().message);
     } else {
         auto parsed_food = this->parseFoodFromOffJson_barcode(r);
         if (!parsed_food) {
             std::cerr << "parsing failed" << std::endl;
+            offRequests("parse_error").inc();
             return cc::utils::Result<cc::models::Food>::fail(cc::utils::ErrorCode::ParseError,
                                                              parsed_food.unwrap_error().message);
         } else {
+            offRequests("ok").inc();
             return parsed_food;
         }
     }
@@ -130,7 +151,6 @@ cc::utils::Result<cc::models::Food> OpenFoodFactsClient::parseFoodFromOffJson_ba
 
         if (product.contains("nutriments") && !product["nutriments"].is_null()) {
             auto nutriments = product.at("nutriments");
-            std::vector<cc::models::Nutrient> ns;
 
             // calories
             if (nutriments.contains("energy-kcal_100g") &&
@@ -138,34 +158,13 @@ cc::utils::Result<cc::models::Food> OpenFoodFactsClient::parseFoodFromOffJson_ba
                 food_item.setCaloriesPer100g(nutriments.at("energy-kcal_100g").get<double>());
             }
 
-            // protein
-
-            if (nutriments.contains("proteins") && !nutriments["proteins"].is_null()) {
-                models::Nutrient p;
-                p.setType(cc::models::NutrientType::Protein);
-                p.setUnit(nutriments.at("proteins_unit").get<std::string>());
-                p.setValue(nutriments.at("proteins_100g").get<double>());
-                ns.push_back(p);
-            }
-
-            // carbs
-            if (nutriments.contains("carbohydrates") && !nutriments["carbohydrates"].is_null()) {
-                models::Nutrient carbs;
-                carbs.setType(cc::models::NutrientType::Carbs);
-                carbs.setUnit(nutriments.at("carbohydrates_unit"));
-                carbs.setValue(nutriments.at("carbohydrates_100g"));
-                ns.push_back(carbs);
-            }
-
-            //  fat
-            if (nutriments.contains("fat") && !nutriments["fat"].is_null()) {
-                models::Nutrient fat;
-                fat.setType(cc::models::NutrientType::Fat);
-                fat.setUnit(nutriments.at("fat_unit"));
-                fat.setValue(nutriments.at("fat_100g"));
-                ns.push_back(fat);
+            // *_100g values are normalized by OFF to grams per 100g, whatever
+            // unit the product page was entered in (*_unit)
+            for (const auto& info : cc::models::NUTRIENTS) {
+                auto it = nutriments.find(std::string(info.offKey) + "_100g");
+                if (it == nutriments.end() || !it->is_number()) continue;
+                food_item.setNutrient(info.type, it->get<double>() * info.offScale, info.unit);
             }
-            food_item.setNutrients(ns);
         }
         return cc::utils::Result<cc::models::Food>::ok(std::move(food_item));
     } else {
@@ -12,7 +12,9 @@ class OpenFoodFactsClient {
     explicit OpenFoodFactsClient(std::string baseUrl = "https://world.openfoodfacts.org",
                                  const std::string userAgent =
                                      "CalorieCounter/1.0 (+https://example.com; anas@example.com)");
-    cc::utils::Result<cc::models::Food> getByBarcode(const std::string& barcode);
+    virtual ~OpenFoodFactsClient() = default;
+    // virtual so services can be tested against a fake client
+    virtual cc::utils::Result<cc::models::Food> getByBarcode(const std::string& barcode);
     cc::utils::Result<cc::models::Food>
     parseFoodFromOffJson_barcode(cc::utils::Result<std::string> food_in_off_json_format);
 
@@ -7,14 +7,74 @@
 #include <ostream>
 #include <string>
 #include <cstdio>   // fileno
+#include <magic_enum.hpp>
 #include <unistd.h> // isatty
 #include "clients/OpenFoodFactsClient.hpp"
+#include "services/FoodResolver.hpp"
 #include "services/FoodService.hpp"
 #include "services/MealService.hpp"
 #include "storage/JsonFoodRepository.hpp"
 #include "storage/JsonMealRepository.hpp"
+#include "utils/ThreadLayout.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/common_functions.hpp"
-int main() {
+
+namespace {
+// value of a "--name value" argument, else of the environment variable
+const char* option(int argc, char** argv, std::string_view name,
+                   const char* env) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (argv[i] == name) return argv[i + 1];
+  }
+  return std::getenv(env);
+}
+
+bool flag(int argc, char** argv, std::string_view name, const char* env) {
+  for (int i = 1; i < argc; i++) {
+    if (argv[i] == name) return true;
+  }
+  const char* value = std::getenv(env);
+  return value && std::string_view(value) == "1";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  // threads: --http-threads/CC_HTTP_THREADS Crow workers,
+  // --pool-threads/CC_POOL_THREADS background workers, --cpus/CC_CPUS
+  // "0-7,16" or "node:1" to keep every thread on those cpus,
+  // --pin-pool/CC_PIN_POOL=1 to give each pool worker one cpu of the set
+  cc::utils::ThreadLayout layout;
+  if (const char* value =
+          option(argc, argv, "--http-threads", "CC_HTTP_THREADS")) {
+    layout.httpWorkers = std::strtoul(value, nullptr, 10);
+  }
+  if (const char* value =
+          option(argc, argv, "--pool-threads", "CC_POOL_THREADS")) {
+    layout.poolThreads = std::strtoul(value, nullptr, 10);
+  }
+  if (const char* value = option(argc, argv, "--cpus", "CC_CPUS")) {
+    auto cpus = cc::utils::parseCpuSpec(value);
+    if (!cpus) {
+      std::cerr << "--cpus: " << cpus.unwrap_error().message << std::endl;
+      return 1;
+    }
+    layout.cpus = cpus.unwrap();
+  }
+  layout.pinPool = flag(argc, argv, "--pin-pool", "CC_PIN_POOL");
+  // before anything starts a thread: they all inherit the mask of main
+  if (!layout.cpus.empty()) {
+    auto pinned = cc::utils::pinCurrentThread(layout.cpus);
+    if (!pinned) {
+      std::cerr << "--cpus: " << pinned.unwrap_error().message << std::endl;
+      return 1;
+    }
+  }
+  cc::utils::ThreadPool::configureShared(
+      layout.poolThreads,
+      layout.pinPool ? layout.cpus : std::vector<int>{});
+  const char* env_port = option(argc, argv, "--port", "CC_PORT");
+  const int port = env_port ? std::atoi(env_port) : 18080;
+
   // setup data base
   const char* env_meals_db = std::getenv("CC_MEALS_DB_PATH");
   std::string meal_db_path =
@@ -39,12 +99,72 @@ int main() {
   cc::clients::OpenFoodFactsClient client;
   std::shared_ptr<cc::clients::OpenFoodFactsClient> client_ptr =
       std::make_shared<cc::clients::OpenFoodFactsClient>(client);
-  cc::services::FoodService food_service{food_repo_shared_ptr, client_ptr};
-  cc::services::MealService meal_service{meal_repo_shared_ptr};
+  // services hold mutexes, so they are created in place and shared
+  auto food_service = std::make_shared<cc::services::FoodService>(
+      food_repo_shared_ptr, client_ptr);
+  // decoded food cache: CC_FOOD_CACHE_BYTES budget, CC_FOOD_CACHE_POLICY LRU|ARC
+  const char* env_cache_bytes = std::getenv("CC_FOOD_CACHE_BYTES");
+  const char* env_cache_policy = std::getenv("CC_FOOD_CACHE_POLICY");
+  if (env_cache_bytes || env_cache_policy) {
+    std::size_t cache_bytes =
+        env_cache_bytes ? std::strtoull(env_cache_bytes, nullptr, 10)
+                        : cc::services::FoodService::kDefaultCacheBytes;
+    auto cache_policy =
+        magic_enum::enum_cast<cc::utils::CachePolicy>(
+            env_cache_policy ? env_cache_policy : "")
+            .value_or(cc::utils::CachePolicy::LRU);
+    food_service->configureCache(cache_bytes, cache_policy);
+  }
+  auto meal_service =
+      std::make_shared<cc::services::MealService>(meal_repo_shared_ptr);
+  // unknown foods of new meals are fetched in the background
+  meal_service->setFoodResolver(
+      std::make_shared<cc::services::FoodResolver>(food_service));
+  // meal kcal and macros are stored on write and kept in sync with the foods
+  meal_service->setFoodService(food_service);
 
-  cc::api::Server server(
-      18080, std::make_shared<cc::services::FoodService>(food_service),
-      std::make_shared<cc::services::MealService>(meal_service));
+  cc::api::Server server(port, food_service, meal_service);
+  server.configureThreads(layout);
+  // response compression: CC_COMPRESSION_MIN_BYTES threshold, CC_COMPRESSION_LEVEL 1..9,
+  // CC_COMPRESSION_CACHE_BYTES budget of the compressed bodies of ETag'd responses
+  cc::api::CompressionMiddleware::Options compression;
+  if (const char* env = std::getenv("CC_COMPRESSION_MIN_BYTES")) {
+    compression.minBytes = std::strtoull(env, nullptr, 10);
+  }
+  if (const char* env = std::getenv("CC_COMPRESSION_LEVEL")) {
+    compression.level = std::atoi(env);
+  }
+  if (const char* env = std::getenv("CC_COMPRESSION_CACHE_BYTES")) {
+    compression.cacheBytes = std::strtoull(env, nullptr, 10);
+  }
+  server.configureCompression(compression);
+  // rate limits: CC_RATE_LIMIT "rate:burst" per client, CC_MAX_IN_FLIGHT
+  // requests at once, CC_ROUTE_LIMITS "/path=rate:burst:maxInFlight,...",
+  // CC_TRUST_FORWARDED_FOR=1 to take the client from X-Forwarded-For
+  cc::api::middleware::RateLimit::Options limits;
+  if (const char* env = std::getenv("CC_RATE_LIMIT")) {
+    auto limit = cc::utils::parseRateLimit(env);
+    if (!limit) {
+      std::cerr << "CC_RATE_LIMIT: " << limit.unwrap_error().message << std::endl;
+      return 1;
+    }
+    limits.client = limit.unwrap();
+  }
+  if (const char* env = std::getenv("CC_MAX_IN_FLIGHT")) {
+    limits.maxInFlight = std::strtoul(env, nullptr, 10);
+  }
+  if (const char* env = std::getenv("CC_ROUTE_LIMITS")) {
+    auto routes = cc::api::middleware::parseRouteLimits(env);
+    if (!routes) {
+      std::cerr << "CC_ROUTE_LIMITS: " << routes.unwrap_error().message
+                << std::endl;
+      return 1;
+    }
+    limits.routes = routes.unwrap();
+  }
+  limits.trustForwardedFor = flag(argc, argv, "--trust-forwarded-for",
+                                  "CC_TRUST_FORWARDED_FOR");
+  server.configureRateLimit(limits);
   server.start();
 
   bool interactive = ::isatty(fileno(stdin));
@@ -12,8 +12,9 @@ Food::Food(std::string id_, std::string name_, double caloriesPer100g_,
            std::vector<Nutrient> nutrient_, 
            std::optional<std::string> barcode_, std::optional<std::string> brand_,
            std::optional<std::string> imageUrl_)
-    : id_{id_}, name_{name_}, caloriesPer100g_{caloriesPer100g_}, nutrients_{nutrient_},
+    : id_{id_}, name_{name_}, caloriesPer100g_{caloriesPer100g_},
      barcode_{barcode_}, brand_{brand_}, imageUrl_{imageUrl_} {
+    this->setNutrients(nutrient_);
 }
 
 std::string Food::to_string() const {
@@ -55,12 +56,43 @@ void Food::setCaloriesPer100g(double kcal) {
     this->caloriesPer100g_ = kcal;
 }
 
-const std::vector<Nutrient>& Food::nutrients() const {
-    return this->nutrients_;
+std::vector<Nutrient> Food::nutrients() const {
+    std::vector<Nutrient> ns;
+    ns.reserve(this->nutrient_present_.count());
+    for (std::size_t i = 0; i < NUTRIENT_COUNT; i++) {
+        if (!this->nutrient_present_[i]) continue;
+        auto type = static_cast<NutrientType>(i);
+        ns.emplace_back(type, this->nutrient_values_[i], std::string(canonicalUnit(type)));
+    }
+    return ns;
 }
 
-void Food::setNutrients(std::vector<Nutrient> ns) {
-    this->nutrients_ = ns;
+void Food::setNutrients(const std::vector<Nutrient>& ns) {
+    this->nutrient_values_.fill(0.0);
+    this->nutrient_present_.reset();
+    for (const auto& n : ns) {
+        const std::size_t i = nutrientIndex(n.type());
+        this->nutrient_values_[i] += toCanonicalUnit(n.type(), n.value(), n.unit());
+        this->nutrient_present_.set(i);
+    }
+}
+
+double Food::nutrient(NutrientType type) const {
+    return this->nutrient_values_[nutrientIndex(type)];
+}
+
+bool Food::hasNutrient(NutrientType type) const {
+    return this->nutrient_present_[nutrientIndex(type)];
+}
+
+void Food::setNutrient(NutrientType type, double value, std::string_view unit) {
+    const std::size_t i = nutrientIndex(type);
+    this->nutrient_values_[i] = toCanonicalUnit(type, value, unit);
+    this->nutrient_present_.set(i);
+}
+
+const Food::NutrientValues& Food::nutrientValues() const {
+    return this->nutrient_values_;
 }
 
 const std::optional<std::string>& Food::imageUrl() const {
@@ -77,6 +109,16 @@ void Food::setSource(SOURCE s) {
     this->source_ = s;
 }
 
+std::size_t Food::approximateBytes() const {
+    auto optional_bytes = [](const std::optional<std::string>& s) {
+        return s ? s->capacity() : 0;
+    };
+    std::size_t bytes = sizeof(Food) + this->id_.capacity() + this->name_.capacity() +
+                        optional_bytes(this->barcode_) + optional_bytes(this->brand_) +
+                        optional_bytes(this->imageUrl_);
+    return bytes;
+}
+
 double Food::totalKcal(double servingSizeG) const {
     return (servingSizeG) * (this->caloriesPer100g_)/100;
 }
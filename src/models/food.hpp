@@ -1,8 +1,11 @@
 #pragma once
+#include <array>
+#include <bitset>
 #include <chrono>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "models/nutrient.hpp"
@@ -13,6 +16,9 @@ enum class SOURCE : uint8_t { Manual, Online };
 // Represents a single food item
 class Food {
   public:
+    // per 100g values in canonical units, indexed by NutrientType
+    using NutrientValues = cc::models::NutrientValues;
+
     Food() = default;
     Food(std::string id_, std::string name_, double caloriesPer100g_,
          std::vector<Nutrient> nutrient_,
@@ -36,8 +42,17 @@ class Food {
 
     double totalKcal(double servingSizeG) const;
 
-    const std::vector<Nutrient>& nutrients() const;
-    void setNutrients(std::vector<Nutrient> ns);
+    // present nutrients in NutrientType order, in canonical units
+    std::vector<Nutrient> nutrients() const;
+    // replaces every nutrient, units are converted at ingest and values of
+    // a repeated type are added up
+    void setNutrients(const std::vector<Nutrient>& ns);
+
+    // 0 when the nutrient is not known for this food
+    double nutrient(NutrientType type) const;
+    bool hasNutrient(NutrientType type) const;
+    void setNutrient(NutrientType type, double value, std::string_view unit = "g");
+    const NutrientValues& nutrientValues() const;
 
     // media/source
     const std::optional<std::string>& imageUrl() const;
@@ -47,13 +62,16 @@ class Food {
     void setSource(SOURCE s);
 
     std::string to_string() const;
+    // rough heap + object footprint, used to budget caches
+    std::size_t approximateBytes() const;
 
   private:
     std::string id_;
     std::string name_;
     double totalKcal_{0.0};
     double caloriesPer100g_{0.0};
-    std::vector<Nutrient> nutrients_;
+    NutrientValues nutrient_values_{};
+    std::bitset<NUTRIENT_COUNT> nutrient_present_;
     std::optional<std::string> barcode_;
     std::optional<std::string> brand_;
     std::optional<std::string> imageUrl_{"img_url_empty"};
@@ -63,7 +81,7 @@ inline void to_json(nlohmann::json& j, const cc::models::Food& f) {
 
     nlohmann::json nutrient_array = nlohmann::json::array();
 
-    for (cc::models::Nutrient i : f.nutrients()) {
+    for (const cc::models::Nutrient& i : f.nutrients()) {
         nlohmann::json n = i;
         nutrient_array.push_back(n);
     }
@@ -40,22 +40,47 @@ void MealLog::setTime(std::chrono::system_clock::time_point tsUtc) {
 
 void MealLog::setFoodItems(std::vector<std::pair<std::string, double>> food_items) {
     this->food_items_ = food_items;
+    this->nutrition_.reset();
 }
 
-std::vector<std::pair<std::string, double>> MealLog::food_items() const {
+void MealLog::setNutrition(std::optional<NutritionTotals> nutrition) {
+    this->nutrition_ = nutrition;
+}
+
+const std::optional<NutritionTotals>& MealLog::nutrition() const {
+    return this->nutrition_;
+}
+
+const std::vector<std::pair<std::string, double>>& MealLog::food_items() const {
     return this->food_items_;
 }
 // operations
 void MealLog::addFoodItem(const std::string& foodId, double grams) {
     this->food_items_.push_back({foodId, grams});
+    this->nutrition_.reset();
 }
 bool MealLog::removeFoodItem(const std::string& foodId) {
     for (auto it = this->food_items_.begin(); it != this->food_items_.end(); it++) {
         if (it->first == foodId) {
             this->food_items_.erase(it);
+            this->nutrition_.reset();
             return true;
         }
     }
     return false;
 }
+
+void NutritionTotals::add(const Food& food, double grams) {
+    this->calories += food.totalKcal(grams);
+    for (const auto& info : NUTRIENTS) {
+        (*this)[info.type] += food.nutrient(info.type) * grams / 100.0;
+    }
+}
+
+void NutritionTotals::addScaled(const NutritionTotals& other, double factor) {
+    this->calories += factor * other.calories;
+    for (std::size_t i = 0; i < NUTRIENT_COUNT; i++) {
+        this->nutrients[i] += factor * other.nutrients[i];
+    }
+}
 } // namespace cc::models
@@ -3,20 +3,41 @@
 #include <chrono>
 #include <magic_enum.hpp>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 #include <atomic>
+#include "models/nutrient.hpp"
 namespace cc::models {
 
 enum class MEALNAME { Breakfast, Lunch, Dinner, Snack }; // enum::MEALNAME
 
+class Food;
+
+// kcal and nutrients (canonical units) of a whole meal
+struct NutritionTotals {
+    double calories{0.0};
+    NutrientValues nutrients{};
+
+    double& operator[](NutrientType type) { return this->nutrients[nutrientIndex(type)]; }
+    double operator[](NutrientType type) const { return this->nutrients[nutrientIndex(type)]; }
+
+    // adds `grams` of a food whose values are given per 100g
+    void add(const Food& food, double grams);
+    // adds factor * other, factor -1 subtracts
+    void addScaled(const NutritionTotals& other, double factor);
+    bool operator==(const NutritionTotals&) const = default;
+};
+
 class MealLog {
   private:
     std::chrono::system_clock::time_point tsUtc_;
     int  id_;
     MEALNAME name_{MEALNAME::Lunch};
     std::vector<std::pair<std::string, double>> food_items_; // foodId, grams
+    // materialized on write, empty when a food item could not be resolved yet
+    std::optional<NutritionTotals> nutrition_;
 
   public:
     // constructors
@@ -28,12 +49,14 @@ class MealLog {
     void setTime(std::chrono::system_clock::time_point tsUtc);
     void setFoodItems(std::vector<std::pair<std::string, double>> food_items);
     void setId(int id);
+    void setNutrition(std::optional<NutritionTotals> nutrition);
     // getters
     MEALNAME getName() const;
     int id() const;
     std::chrono::system_clock::time_point gettime() const;
-    std::vector<std::pair<std::string, double>> food_items() const;
-    // operations
+    const std::vector<std::pair<std::string, double>>& food_items() const;
+    const std::optional<NutritionTotals>& nutrition() const;
+    // operations (changing the food items drops the stored nutrition)
     void addFoodItem(const std::string& foodId, double grams);
     bool removeFoodItem(const std::string& foodId);
 
@@ -49,6 +72,12 @@ inline void to_json(nlohmann::json& j, const cc::models::MealLog& m) {
              m.food_items(),
          },
          {"tsUtc", cc::utils::toIso8601(m.gettime())}};
+    if (m.nutrition()) {
+        j["calories"] = m.nutrition()->calories;
+        for (const auto& info : NUTRIENTS) {
+            j[magic_enum::enum_name(info.type)] = (*m.nutrition())[info.type];
+        }
+    }
 }
 
 inline void from_json(const nlohmann::json& j, cc::models::MealLog& m) {
@@ -57,5 +86,14 @@ inline void from_json(const nlohmann::json& j, cc::models::MealLog& m) {
     m.setId(j.at("id").get<int>());
     m.setTime(cc::utils::fromIso8601(j.at("tsUtc").get<std::string>()));
     m.setFoodItems(j.at("foodItems").get<std::vector<std::pair<std::string, double>>>());
+    // meals written before nutrition was materialized have no totals
+    if (j.contains("calories")) {
+        NutritionTotals totals;
+        totals.calories = j.at("calories").get<double>();
+        for (const auto& info : NUTRIENTS) {
+            totals[info.type] = j.value(magic_enum::enum_name(info.type), 0.0);
+        }
+        m.setNutrition(totals);
+    }
 }
 } // namespace cc::models
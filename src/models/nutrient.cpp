@@ -33,6 +33,26 @@ void Nutrient::setUnit(std::string u) {
     this->unit_ = u;
 }
 
+namespace {
+// grams per `unit`, 0 for units that are not masses
+double gramsPerUnit(std::string_view unit) {
+    if (unit == "g") return 1.0;
+    if (unit == "kg") return 1000.0;
+    if (unit == "mg") return 1e-3;
+    if (unit == "µg" || unit == "ug" || unit == "mcg") return 1e-6;
+    return 0.0;
+}
+} // namespace
+
+double toCanonicalUnit(NutrientType type, double value, std::string_view unit) {
+    const std::string_view canonical = canonicalUnit(type);
+    if (unit == canonical || unit.empty()) return value;
+    const double from = gramsPerUnit(unit);
+    const double to = gramsPerUnit(canonical);
+    if (from == 0.0 || to == 0.0) return value;
+    return value * from / to;
+}
+
 std::string Nutrient::to_string() const {
     return std::format("{} : {} : {}", magic_enum::enum_name(this->type_), this->value_, this->unit_);
 }
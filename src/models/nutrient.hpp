@@ -1,11 +1,61 @@
 #pragma once
 #include <nlohmann/json.hpp>
+#include <array>
+#include <cstddef>
 #include <format>
 #include <string>
+#include <string_view>
 #include <magic_enum.hpp>
 namespace cc::models {
 
-enum class NutrientType{Protein,Carbs,Fat,Unknown};
+enum class NutrientType{Protein,Carbs,Fat,Fiber,Sugars,SaturatedFat,Salt,Sodium,Unknown};
+// one slot per NutrientType in Food's fixed nutrient array
+inline constexpr std::size_t NUTRIENT_COUNT = magic_enum::enum_count<NutrientType>();
+// one value per NutrientType, indexed by the enum
+using NutrientValues = std::array<double, NUTRIENT_COUNT>;
+
+// Everything known about a nutrient at compile time. Parsing, storage
+// columns and aggregation loop over NUTRIENTS, so a new nutrient is a new
+// enum value plus one row below.
+struct NutrientInfo {
+    NutrientType type;
+    std::string_view offKey; // Open Food Facts "<offKey>_100g" field
+    std::string_view unit;   // canonical unit values are stored in
+    double offScale;         // OFF *_100g values are grams, times this gives `unit`
+};
+
+// every type but Unknown, in enum order
+inline constexpr std::array<NutrientInfo, NUTRIENT_COUNT - 1> NUTRIENTS{{
+    {NutrientType::Protein, "proteins", "g", 1.0},
+    {NutrientType::Carbs, "carbohydrates", "g", 1.0},
+    {NutrientType::Fat, "fat", "g", 1.0},
+    {NutrientType::Fiber, "fiber", "g", 1.0},
+    {NutrientType::Sugars, "sugars", "g", 1.0},
+    {NutrientType::SaturatedFat, "saturated-fat", "g", 1.0},
+    {NutrientType::Salt, "salt", "g", 1.0},
+    {NutrientType::Sodium, "sodium", "mg", 1000.0},
+}};
+
+constexpr bool nutrientTableIsOrdered() {
+    for (std::size_t i = 0; i < NUTRIENTS.size(); i++) {
+        if (static_cast<std::size_t>(NUTRIENTS[i].type) != i) return false;
+    }
+    return NutrientType::Unknown == static_cast<NutrientType>(NUTRIENTS.size());
+}
+static_assert(nutrientTableIsOrdered(), "NUTRIENTS rows must follow NutrientType, Unknown last");
+
+constexpr std::size_t nutrientIndex(NutrientType type) {
+    return static_cast<std::size_t>(type);
+}
+
+// unit a nutrient value is stored in
+constexpr std::string_view canonicalUnit(NutrientType type) {
+    return type == NutrientType::Unknown ? std::string_view{"g"} : NUTRIENTS[nutrientIndex(type)].unit;
+}
+// converts `value` given in `unit` to the canonical unit of `type`,
+// unknown units are taken as already canonical
+double toCanonicalUnit(NutrientType type, double value, std::string_view unit);
+
 class Nutrient {
   private:
     NutrientType type_;      
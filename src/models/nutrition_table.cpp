@@ -0,0 +1,186 @@
+#include "models/nutrition_table.hpp"
+
+#include <mutex>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CC_NUTRITION_X86 1
+#include <immintrin.h>
+#endif
+
+namespace cc::models {
+
+namespace {
+
+// each kernel returns sum over i of column[slots[i]] * grams[i]
+double accumulateScalar(const double* column, const std::uint32_t* slots, const double* grams,
+                        std::size_t count) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < count; i++) {
+        sum += column[slots[i]] * grams[i];
+    }
+    return sum;
+}
+
+#ifdef CC_NUTRITION_X86
+// SSE2 is part of x86-64, it has no gather so lanes are loaded one by one
+double accumulateSse2(const double* column, const std::uint32_t* slots, const double* grams,
+                      std::size_t count) {
+    __m128d sum = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d g = _mm_loadu_pd(grams + i);
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set_pd(column[slots[i + 1]], column[slots[i]]), g));
+    }
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum))) +
+           accumulateScalar(column, slots + i, grams + i, count - i);
+}
+
+__attribute__((target("avx2,fma"))) double horizontalSum(__m256d v) {
+    const __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+__attribute__((target("avx2,fma"))) double accumulateAvx2(const double* column,
+                                                           const std::uint32_t* slots,
+                                                           const double* grams,
+                                                           std::size_t count) {
+    __m256d sum = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slots + i));
+        const __m256d g = _mm256_loadu_pd(grams + i);
+        sum = _mm256_fmadd_pd(_mm256_i32gather_pd(column, idx, 8), g, sum);
+    }
+    return horizontalSum(sum) + accumulateScalar(column, slots + i, grams + i, count - i);
+}
+#endif
+
+double accumulateColumn(const double* column, const std::uint32_t* slots, const double* grams,
+                        std::size_t count, SimdLevel level) {
+#ifdef CC_NUTRITION_X86
+    if (level == SimdLevel::AVX2) return accumulateAvx2(column, slots, grams, count);
+    if (level == SimdLevel::SSE2) return accumulateSse2(column, slots, grams, count);
+#else
+    (void)level;
+#endif
+    return accumulateScalar(column, slots, grams, count);
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#ifdef CC_NUTRITION_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+NutritionTotals accumulateNutrition(const NutritionColumns& columns, const std::uint32_t* slots,
+                                    const double* grams, std::size_t count, SimdLevel level) {
+    // one pass per column, slots and grams stay in L1 between passes;
+    // values are per 100g
+    NutritionTotals t;
+    t.calories = accumulateColumn(columns.kcal, slots, grams, count, level) / 100.0;
+    for (const auto& info : NUTRIENTS) {
+        const double* column = columns.nutrients[nutrientIndex(info.type)];
+        t[info.type] = accumulateColumn(column, slots, grams, count, level) / 100.0;
+    }
+    return t;
+}
+
+NutritionTable::NutritionTable() : level_{detectSimdLevel()} {}
+
+void NutritionTable::upsert(const std::string& foodId, const Food& food,
+                            std::optional<std::uint64_t> loadedAtEpoch) {
+    std::unique_lock<std::shared_mutex> lock(this->mtx_);
+    if (loadedAtEpoch && *loadedAtEpoch != this->epoch_) return;
+    std::uint32_t slot;
+    auto it = this->slots_.find(foodId);
+    if (it != this->slots_.end()) {
+        slot = it->second;
+    } else if (!this->free_slots_.empty()) {
+        slot = this->free_slots_.back();
+        this->free_slots_.pop_back();
+        this->slots_.emplace(foodId, slot);
+    } else {
+        slot = static_cast<std::uint32_t>(this->kcal_.size());
+        this->kcal_.push_back(0);
+        for (auto& column : this->nutrients_) {
+            column.push_back(0);
+        }
+        this->slots_.emplace(foodId, slot);
+    }
+    this->kcal_[slot] = food.caloriesPer100g();
+    for (const auto& info : NUTRIENTS) {
+        this->nutrients_[nutrientIndex(info.type)][slot] = food.nutrient(info.type);
+    }
+}
+
+void NutritionTable::erase(const std::string& foodId) {
+    std::unique_lock<std::shared_mutex> lock(this->mtx_);
+    this->epoch_++;
+    auto it = this->slots_.find(foodId);
+    if (it == this->slots_.end()) return;
+    this->free_slots_.push_back(it->second);
+    this->slots_.erase(it);
+}
+
+void NutritionTable::clear() {
+    std::unique_lock<std::shared_mutex> lock(this->mtx_);
+    this->epoch_++;
+    this->slots_.clear();
+    this->free_slots_.clear();
+    this->kcal_.clear();
+    for (auto& column : this->nutrients_) {
+        column.clear();
+    }
+}
+
+std::uint64_t NutritionTable::epoch() const {
+    std::shared_lock<std::shared_mutex> lock(this->mtx_);
+    return this->epoch_;
+}
+
+std::optional<NutritionTotals>
+NutritionTable::totals(const std::vector<std::pair<std::string, double>>& items) const {
+    std::vector<std::uint32_t> slots;
+    std::vector<double> grams;
+    slots.reserve(items.size());
+    grams.reserve(items.size());
+
+    std::shared_lock<std::shared_mutex> lock(this->mtx_);
+    for (const auto& [food_id, g] : items) {
+        auto it = this->slots_.find(food_id);
+        if (it == this->slots_.end()) return std::nullopt;
+        slots.push_back(it->second);
+        grams.push_back(g);
+    }
+    NutritionColumns columns{this->kcal_.data(), {}};
+    for (std::size_t i = 0; i < this->nutrients_.size(); i++) {
+        columns.nutrients[i] = this->nutrients_[i].data();
+    }
+    return accumulateNutrition(columns, slots.data(), grams.data(), slots.size(), this->level_);
+}
+
+std::vector<std::string>
+NutritionTable::missing(const std::vector<std::pair<std::string, double>>& items) const {
+    std::vector<std::string> ids;
+    std::shared_lock<std::shared_mutex> lock(this->mtx_);
+    for (const auto& [food_id, g] : items) {
+        if (!this->slots_.contains(food_id)) ids.push_back(food_id);
+    }
+    return ids;
+}
+
+std::size_t NutritionTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(this->mtx_);
+    return this->slots_.size();
+}
+
+SimdLevel NutritionTable::simdLevel() const { return this->level_; }
+
+} // namespace cc::models
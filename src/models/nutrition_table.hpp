@@ -0,0 +1,68 @@
+#pragma once
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "models/nutrient.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cc::models {
+
+enum class SimdLevel : std::uint8_t { Scalar, SSE2, AVX2 };
+
+// read-only view of the table columns, values per 100g indexed by slot
+struct NutritionColumns {
+    const double* kcal;
+    // one column per NUTRIENTS row, indexed by NutrientType
+    std::array<const double*, NUTRIENTS.size()> nutrients;
+};
+
+// sum over i of column[slots[i]] * grams[i] / 100 for every column
+NutritionTotals accumulateNutrition(const NutritionColumns& columns, const std::uint32_t* slots,
+                                    const double* grams, std::size_t count, SimdLevel level);
+// best level supported by this CPU (AVX2 needs FMA as well)
+SimdLevel detectSimdLevel();
+
+// Structure of arrays copy of the nutrition values of the foods in use:
+// one slot per food, one contiguous column per value, so meal totals are a
+// gather-multiply-accumulate over slots instead of walking Food objects.
+class NutritionTable {
+  public:
+    NutritionTable();
+
+    // stores the food's values under foodId, dropped if the table was
+    // invalidated since loadedAtEpoch (see epoch())
+    void upsert(const std::string& foodId, const Food& food,
+                std::optional<std::uint64_t> loadedAtEpoch = std::nullopt);
+    void erase(const std::string& foodId);
+    void clear();
+    // bumped by erase and clear
+    std::uint64_t epoch() const;
+
+    // totals of the items (foodId, grams), empty if a food is not in the table
+    std::optional<NutritionTotals>
+    totals(const std::vector<std::pair<std::string, double>>& items) const;
+    // the ids of items that are not in the table
+    std::vector<std::string>
+    missing(const std::vector<std::pair<std::string, double>>& items) const;
+
+    std::size_t size() const;
+    SimdLevel simdLevel() const;
+
+  private:
+    mutable std::shared_mutex mtx_;
+    std::unordered_map<std::string, std::uint32_t> slots_;
+    std::vector<std::uint32_t> free_slots_;
+    std::vector<double> kcal_;
+    std::array<std::vector<double>, NUTRIENTS.size()> nutrients_;
+    std::uint64_t epoch_{0};
+    SimdLevel level_;
+};
+
+} // namespace cc::models
@@ -0,0 +1,230 @@
+#include "DailyAggregateStore.hpp"
+
+#include <algorithm>
+
+namespace cc {
+namespace services {
+
+namespace {
+constexpr std::chrono::sys_days TREE_FIRST_DAY{std::chrono::year{1970} / 1 / 1};
+constexpr std::chrono::sys_days TREE_LAST_DAY{std::chrono::year{2099} / 12 / 31};
+}  // namespace
+
+DailyTotals& DailyTotals::operator+=(const DailyTotals& other) {
+  this->mealsCount += other.mealsCount;
+  this->pendingMeals += other.pendingMeals;
+  this->totals.addScaled(other.totals, 1.0);
+  return *this;
+}
+
+DailyTotals& DailyTotals::operator-=(const DailyTotals& other) {
+  this->mealsCount -= other.mealsCount;
+  this->pendingMeals -= other.pendingMeals;
+  this->totals.addScaled(other.totals, -1.0);
+  return *this;
+}
+
+DailyAggregateStore::Day DailyAggregateStore::dayOf(
+    const cc::models::MealLog& meal) {
+  return std::chrono::floor<std::chrono::days>(meal.gettime());
+}
+
+void DailyAggregateStore::add(const cc::models::MealLog& meal) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->apply(meal, +1);
+}
+
+void DailyAggregateStore::remove(const cc::models::MealLog& meal) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->apply(meal, -1);
+}
+
+void DailyAggregateStore::rebuild(
+    const std::vector<cc::models::MealLog>& meals) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->days_.clear();
+  this->tree_ = cc::utils::FenwickTree<DailyTotals>{};
+  for (const auto& meal : meals) {
+    this->apply(meal, +1);
+  }
+  this->versions_.bumpAll();
+}
+
+void DailyAggregateStore::clear() {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->days_.clear();
+  this->tree_ = cc::utils::FenwickTree<DailyTotals>{};
+  this->versions_.bumpAll();
+}
+
+DailyTotals DailyAggregateStore::get(Day day, std::uint64_t* version) const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  if (version) *version = this->versions_.day(day);
+  auto it = this->days_.find(day);
+  return it == this->days_.end() ? DailyTotals{} : it->second;
+}
+
+std::uint64_t DailyAggregateStore::dayVersion(Day day) const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return this->versions_.day(day);
+}
+
+DailyTotals DailyAggregateStore::sum(Day from, Day to) const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return this->sumLocked(from, to);
+}
+
+std::vector<SeriesPoint> DailyAggregateStore::series(Day from, Day to,
+                                                     std::size_t points) const {
+  std::vector<SeriesPoint> out;
+  if (from > to || points == 0) return out;
+  const std::size_t total_days = (to - from).count() + 1;
+  points = std::min(points, total_days);
+  out.reserve(points);
+
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  auto day_it = this->days_.lower_bound(from);
+  for (std::size_t i = 0; i < points; i++) {
+    SeriesPoint point;
+    point.start = from + std::chrono::days{i * total_days / points};
+    point.end = from + std::chrono::days{(i + 1) * total_days / points} -
+                std::chrono::days{1};
+    point.totals = this->sumLocked(point.start, point.end);
+
+    const std::size_t bucket_days = (point.end - point.start).count() + 1;
+    std::size_t days_with_meals = 0;
+    bool first = true;
+    for (; day_it != this->days_.end() && day_it->first <= point.end; ++day_it) {
+      const double kcal = day_it->second.totals.calories;
+      point.minCalories = first ? kcal : std::min(point.minCalories, kcal);
+      point.maxCalories = first ? kcal : std::max(point.maxCalories, kcal);
+      first = false;
+      days_with_meals++;
+    }
+    if (days_with_meals < bucket_days) {
+      point.minCalories = std::min(point.minCalories, 0.0);
+    }
+    out.push_back(point);
+  }
+  return out;
+}
+
+DailyTotals DailyAggregateStore::sumLocked(Day from, Day to) const {
+  DailyTotals total;
+  if (from > to) return total;
+  // the few days outside the window are summed from the map
+  for (auto it = this->days_.lower_bound(from);
+       it != this->days_.end() && it->first < TREE_FIRST_DAY && it->first <= to;
+       ++it) {
+    total += it->second;
+  }
+  for (auto it = this->days_.upper_bound(std::max(from - std::chrono::days{1},
+                                                  TREE_LAST_DAY));
+       it != this->days_.end() && it->first <= to; ++it) {
+    total += it->second;
+  }
+  const Day last = this->origin_ + std::chrono::days{this->tree_.size()} -
+                   std::chrono::days{1};
+  from = std::max(from, this->origin_);
+  to = std::min(to, last);
+  if (this->tree_.size() == 0 || from > to) return total;
+  total += this->tree_.range((from - this->origin_).count(),
+                             (to - this->origin_).count());
+  return total;
+}
+
+std::vector<PeriodTotals> DailyAggregateStore::periods(
+    Day from, Day to, Granularity granularity) const {
+  using namespace std::chrono;
+  std::vector<PeriodTotals> out;
+  for (Day start = from; start <= to;) {
+    Day next;
+    if (granularity == Granularity::Week) {
+      const unsigned iso_day = weekday{start}.iso_encoding();  // Monday = 1
+      next = start + std::chrono::days{8 - iso_day};
+    } else if (granularity == Granularity::Month) {
+      const year_month_day ymd{start};
+      next = sys_days{(ymd.year() / ymd.month() / 1) + months{1}};
+    } else {
+      next = start + std::chrono::days{1};
+    }
+    const Day end = std::min(next - std::chrono::days{1}, to);
+    out.push_back(PeriodTotals{start, end, this->sum(start, end)});
+    start = next;
+  }
+  return out;
+}
+
+std::size_t DailyAggregateStore::periodCount(Day from, Day to,
+                                             Granularity granularity) {
+  using namespace std::chrono;
+  if (from > to) return 0;
+  if (granularity == Granularity::Week) {
+    // Mondays of the first and last week
+    const Day first = from - std::chrono::days{weekday{from}.iso_encoding() - 1};
+    const Day last = to - std::chrono::days{weekday{to}.iso_encoding() - 1};
+    return (last - first).count() / 7 + 1;
+  }
+  if (granularity == Granularity::Month) {
+    const year_month_day a{from};
+    const year_month_day b{to};
+    return (b.year() / b.month() - a.year() / a.month()).count() + 1;
+  }
+  return (to - from).count() + 1;
+}
+
+std::size_t DailyAggregateStore::days() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return this->days_.size();
+}
+
+void DailyAggregateStore::apply(const cc::models::MealLog& meal, int sign) {
+  const Day day = dayOf(meal);
+  const bool in_tree = inTreeWindow(day);
+  if (in_tree) this->ensureCovered(day);
+  DailyTotals& totals = this->days_[day];
+  const DailyTotals before = totals;
+  totals.mealsCount += sign;
+  if (const auto& nutrition = meal.nutrition()) {
+    totals.totals.addScaled(*nutrition, sign);
+  } else {
+    totals.pendingMeals += sign;
+  }
+  DailyTotals delta = totals;
+  // an empty day goes away instead of keeping rounding leftovers
+  if (totals.mealsCount <= 0) {
+    this->days_.erase(day);
+    delta = DailyTotals{};
+  }
+  delta -= before;
+  if (in_tree) this->tree_.add((day - this->origin_).count(), delta);
+  this->versions_.bumpDay(day);
+}
+
+bool DailyAggregateStore::inTreeWindow(Day day) {
+  return day >= TREE_FIRST_DAY && day <= TREE_LAST_DAY;
+}
+
+void DailyAggregateStore::ensureCovered(Day day) {
+  const Day end = this->origin_ + std::chrono::days{this->tree_.size()};
+  if (this->tree_.size() > 0 && day >= this->origin_ && day < end) return;
+
+  Day first = this->tree_.size() > 0 ? std::min(this->origin_, day) : day;
+  Day last = this->tree_.size() > 0 ? std::max(end - std::chrono::days{1}, day) : day;
+  // double the span so a steady stream of new days rebuilds rarely
+  std::size_t size = std::max<std::size_t>(64, this->tree_.size());
+  while (size < static_cast<std::size_t>((last - first).count() + 1)) size *= 2;
+  if (this->tree_.size() > 0 && day < this->origin_) {
+    // grow towards the past when the new day is before the origin
+    first = last - std::chrono::days{size - 1};
+  }
+
+  this->origin_ = first;
+  this->tree_ = cc::utils::FenwickTree<DailyTotals>{size};
+  for (const auto& [d, totals] : this->days_) {
+    if (inTreeWindow(d)) this->tree_.add((d - this->origin_).count(), totals);
+  }
+}
+
+}  // namespace services
+}  // namespace cc
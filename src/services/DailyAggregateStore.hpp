@@ -0,0 +1,96 @@
+#pragma once
+#include "models/meal_log.hpp"
+#include "storage/VersionCounters.hpp"
+#include "utils/FenwickTree.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace cc::services {
+
+// per day totals of all meals logged that day (UTC)
+struct DailyTotals {
+    int mealsCount{0};
+    // meals counted above whose nutrition is not materialized yet
+    int pendingMeals{0};
+    cc::models::NutritionTotals totals;
+
+    DailyTotals& operator+=(const DailyTotals& other);
+    DailyTotals& operator-=(const DailyTotals& other);
+};
+
+enum class Granularity : std::uint8_t { Day, Week, Month };
+
+// totals of the days start..end (both included)
+struct PeriodTotals {
+    std::chrono::sys_days start;
+    std::chrono::sys_days end;
+    DailyTotals totals;
+};
+
+// one point of a downsampled series: totals of start..end and the lowest and
+// highest daily kcal in it (days without meals count as 0)
+struct SeriesPoint {
+    std::chrono::sys_days start;
+    std::chrono::sys_days end;
+    DailyTotals totals;
+    double minCalories{0.0};
+    double maxCalories{0.0};
+};
+
+// In-memory per day aggregates, kept up to date by MealService on every
+// meal write and nutrition recompute so reading a day is a single lookup.
+// A Fenwick tree over the days answers the sum of any day range in O(log n).
+class DailyAggregateStore {
+  public:
+    using Day = std::chrono::sys_days;
+
+    static Day dayOf(const cc::models::MealLog& meal);
+
+    void add(const cc::models::MealLog& meal);
+    void remove(const cc::models::MealLog& meal);
+    // drops everything and aggregates the given meals
+    void rebuild(const std::vector<cc::models::MealLog>& meals);
+    void clear();
+
+    // an empty DailyTotals for days without meals; version, when given,
+    // gets the day's version read together with the totals
+    DailyTotals get(Day day, std::uint64_t* version = nullptr) const;
+    // bumped with the totals of the day, under the same lock, so a version
+    // never goes with older totals (the /stats/day ETag)
+    std::uint64_t dayVersion(Day day) const;
+    // totals of all days from..to, both included
+    DailyTotals sum(Day from, Day to) const;
+    // from..to split in days, ISO weeks (Monday first) or calendar months,
+    // the first and last period are clipped to the range
+    std::vector<PeriodTotals> periods(Day from, Day to, Granularity granularity) const;
+    // how many periods periods() returns, from the dates alone
+    static std::size_t periodCount(Day from, Day to, Granularity granularity);
+    // from..to cut in at most `points` buckets of (almost) equal length; sums
+    // come from the tree, min/max only visit the days that have meals
+    std::vector<SeriesPoint> series(Day from, Day to, std::size_t points) const;
+    std::size_t days() const;
+
+  private:
+    void apply(const cc::models::MealLog& meal, int sign);
+    // days the tree may cover; meals outside (a typo like year 0001) are
+    // only kept in days_, so one of them can't stretch the tree over
+    // thousands of years
+    static bool inTreeWindow(Day day);
+    // makes the tree cover `day`, rebuilding it from days_ when it grows
+    void ensureCovered(Day day);
+    DailyTotals sumLocked(Day from, Day to) const;
+
+    mutable std::mutex mtx_;
+    // every day with meals, including those outside the tree window
+    std::map<Day, DailyTotals> days_;
+    // slot i holds the totals of origin_ + i days, for days in the window
+    Day origin_{};
+    cc::utils::FenwickTree<DailyTotals> tree_;
+    cc::storage::VersionCounters versions_;
+};
+
+} // namespace cc::services
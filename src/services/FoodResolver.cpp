@@ -0,0 +1,104 @@
+#include "FoodResolver.hpp"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cc {
+namespace services {
+
+FoodResolver::FoodResolver(std::shared_ptr<FoodService> foodService)
+    : foodService_{foodService} {
+  this->worker_ = std::thread([this] { this->run(); });
+}
+
+FoodResolver::~FoodResolver() { this->stop(); }
+
+void FoodResolver::enqueue(const std::vector<std::string>& foodIds) {
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    if (this->stopping_) return;
+    const auto now = Clock::now();
+    for (const auto& id : foodIds) {
+      if (id.empty() || this->queued_.contains(id)) continue;
+      this->queued_.insert(id);
+      this->queue_.emplace_back(id, now);
+    }
+  }
+  this->cv_.notify_one();
+}
+
+FoodResolver::Stats FoodResolver::stats() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  Stats s = this->stats_;
+  s.queueDepth = this->queue_.size();
+  if (!this->queue_.empty()) {
+    s.lagMs = std::chrono::duration<double, std::milli>(
+                  Clock::now() - this->queue_.front().second)
+                  .count();
+  }
+  return s;
+}
+
+void FoodResolver::waitIdle() {
+  std::unique_lock<std::mutex> lock(this->mtx_);
+  this->idle_cv_.wait(lock, [this] {
+    return (this->queue_.empty() && !this->busy_) || this->stopping_;
+  });
+}
+
+void FoodResolver::stop() {
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->stopping_ = true;
+  }
+  this->cv_.notify_all();
+  this->idle_cv_.notify_all();
+  if (this->worker_.joinable()) {
+    this->worker_.join();
+  }
+}
+
+void FoodResolver::run() {
+  while (true) {
+    std::string id;
+    {
+      std::unique_lock<std::mutex> lock(this->mtx_);
+      this->cv_.wait(lock,
+                     [this] { return this->stopping_ || !this->queue_.empty(); });
+      if (this->stopping_) return;
+      auto [next_id, queued_at] = std::move(this->queue_.front());
+      this->queue_.pop_front();
+      this->queued_.erase(next_id);
+      this->stats_.lastWaitMs =
+          std::chrono::duration<double, std::milli>(Clock::now() - queued_at)
+              .count();
+      this->busy_ = true;
+      id = std::move(next_id);
+    }
+
+    bool ok = false;
+    try {
+      // a local hit is cheap, a miss is fetched and saved by the service
+      ok = static_cast<bool>(this->foodService_->getOrFetchByBarcode(id));
+    } catch (const std::exception& e) {
+      std::cerr << "food resolver: " << id << " : " << e.what() << std::endl;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->mtx_);
+      this->busy_ = false;
+      if (ok) {
+        this->stats_.resolved++;
+      } else {
+        this->stats_.failed++;
+      }
+    }
+    this->idle_cv_.notify_all();
+  }
+}
+
+}  // namespace services
+}  // namespace cc
@@ -0,0 +1,60 @@
+#pragma once
+#include "services/FoodService.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace cc::services {
+
+// Resolves meal food ids in the background so that read paths find them
+// already saved in the local data base instead of fetching them from OFF.
+class FoodResolver {
+  public:
+    struct Stats {
+        std::size_t queueDepth{0};
+        // age of the oldest id still waiting in the queue
+        double lagMs{0.0};
+        // time the last resolved id spent waiting before being picked up
+        double lastWaitMs{0.0};
+        std::uint64_t resolved{0};
+        std::uint64_t failed{0};
+    };
+
+    explicit FoodResolver(std::shared_ptr<FoodService> foodService);
+    ~FoodResolver();
+
+    FoodResolver(const FoodResolver&) = delete;
+    FoodResolver& operator=(const FoodResolver&) = delete;
+
+    // ids already waiting in the queue are not queued twice
+    void enqueue(const std::vector<std::string>& foodIds);
+    Stats stats() const;
+    // blocks until the queue is empty and no id is being resolved
+    void waitIdle();
+    void stop();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    void run();
+
+    std::shared_ptr<FoodService> foodService_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::pair<std::string, Clock::time_point>> queue_;
+    std::unordered_set<std::string> queued_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    Stats stats_;
+    std::thread worker_;
+};
+
+} // namespace cc::services
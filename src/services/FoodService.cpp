@@ -1,13 +1,33 @@
 #include "FoodService.hpp"
 #include "models/food.hpp"
+#include "utils/Metrics.hpp"
 #include "utils/Result.hpp"
+#include "utils/ThreadPool.hpp"
+#include <array>
 #include <format>
+#include <future>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace cc {
 namespace services {
 
+namespace {
+enum class LookupSource : std::uint8_t { Cache, Storage, Off, Missing };
+
+// foods asked by id or barcode, by where they were found; coalesced
+// OpenFoodFacts fetches count once
+cc::utils::Counter& foodLookups(LookupSource source) {
+    static auto& family = cc::utils::MetricsRegistry::global().counter(
+        "cc_food_lookups_total", "Food lookups by where the food was found", {"source"});
+    static const std::array<cc::utils::Counter*, 4> counters{
+        &family.labels({"cache"}), &family.labels({"storage"}), &family.labels({"off"}),
+        &family.labels({"missing"})};
+    return *counters[static_cast<std::size_t>(source)];
+}
+} // namespace
+
 FoodService::FoodService(std::shared_ptr<cc::storage::FoodRepository> repo,
                          std::shared_ptr<cc::clients::OpenFoodFactsClient> off)
     : repo_{repo}, off_{off}
@@ -15,26 +35,145 @@ FoodService::FoodService(std::shared_ptr<cc::storage::FoodRepository> repo,
 {}
 
 cc::utils::Result<cc::models::Food> FoodService::getOrFetchByBarcode(const std::string& bardcode) {
+    if (auto cached = this->cache_.get(bardcode)) {
+        foodLookups(LookupSource::Cache).inc();
+        return cc::utils::Result<cc::models::Food>::ok(std::move(*cached));
+    }
+    const std::uint64_t epoch = this->cache_.epoch();
     cc::utils::Result<cc::models::Food> f;
     f = this->repo_->getById_or_Barcode(bardcode);
     if (f) {
-        return f;
+        foodLookups(LookupSource::Storage).inc();
     } else {
-        f = this->off_->getByBarcode(bardcode);
-        if (f) {
-            // save food in data base so next time will be available no need to look online
-            this->repo_->save(f.unwrap());
-            return f;
-        }
+        f = this->fetchOnline(bardcode);
+    }
+    if (f) {
+        this->cache_.put(bardcode, f.unwrap(), f.unwrap().approximateBytes(), epoch);
+        return f;
     }
     return cc::utils::Result<cc::models::Food>::fail(cc::utils::ErrorCode::NotFound,
                                                      "Food not found");
 }
 
+std::vector<cc::utils::Result<cc::models::Food>>
+FoodService::getOrFetchMany(std::span<const std::string> barcodes) {
+    std::vector<cc::utils::Result<cc::models::Food>> results = this->getLocalMany(barcodes);
+
+    // each missing barcode is fetched once, even if it is asked several times
+    const std::uint64_t epoch = this->cache_.epoch();
+    std::unordered_map<std::string, std::future<cc::utils::Result<cc::models::Food>>> misses;
+    cc::utils::ThreadPool& pool = cc::utils::ThreadPool::shared();
+    for (std::size_t i = 0; i < barcodes.size(); i++) {
+        if (!results[i] && !misses.contains(barcodes[i])) {
+            const std::string& barcode = barcodes[i];
+            misses.emplace(barcode,
+                           pool.submit([this, barcode]() { return this->fetchOnline(barcode); }));
+        }
+    }
+    std::unordered_map<std::string, cc::utils::Result<cc::models::Food>> fetched;
+    for (auto& [barcode, future] : misses) {
+        auto result = pool.wait(future);
+        if (result) {
+            this->cache_.put(barcode, result.unwrap(), result.unwrap().approximateBytes(), epoch);
+        }
+        fetched.emplace(barcode, std::move(result));
+    }
+
+    for (std::size_t i = 0; i < barcodes.size(); i++) {
+        if (!results[i]) {
+            // keep the original error so callers can report it per barcode
+            results[i] = fetched.at(barcodes[i]);
+        }
+    }
+    return results;
+}
+
+std::vector<cc::utils::Result<cc::models::Food>>
+FoodService::getLocalMany(std::span<const std::string> barcodes) {
+    std::vector<cc::utils::Result<cc::models::Food>> results(barcodes.size());
+    std::unordered_map<std::string, cc::models::Food> local;
+    std::vector<std::string> not_cached;
+    for (const auto& barcode : barcodes) {
+        if (local.contains(barcode)) continue;
+        if (auto cached = this->cache_.get(barcode)) {
+            local.emplace(barcode, std::move(*cached));
+        } else {
+            not_cached.push_back(barcode);
+        }
+    }
+
+    foodLookups(LookupSource::Cache).inc(local.size());
+    const std::uint64_t epoch = this->cache_.epoch();
+    if (!not_cached.empty()) {
+        cc::utils::Result<std::vector<cc::models::Food>> found = this->repo_->getMany(not_cached);
+        if (found) {
+            foodLookups(LookupSource::Storage).inc(found.unwrap().size());
+            for (const auto& food : found.unwrap()) {
+                this->cache_.put(food.id(), food, food.approximateBytes(), epoch);
+                local.emplace(food.id(), food);
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < barcodes.size(); i++) {
+        auto hit = local.find(barcodes[i]);
+        if (hit != local.end()) {
+            results[i] = cc::utils::Result<cc::models::Food>::ok(hit->second);
+        } else {
+            results[i] = cc::utils::Result<cc::models::Food>::fail(cc::utils::ErrorCode::NotFound,
+                                                                   "Food not found");
+        }
+    }
+    return results;
+}
+
+std::optional<cc::models::NutritionTotals> FoodService::nutritionTotals(
+    const std::vector<std::pair<std::string, double>>& items) {
+    // a food changed while its values were loaded is loaded again
+    constexpr int ATTEMPTS = 3;
+    for (int attempt = 0; attempt < ATTEMPTS; attempt++) {
+        if (auto totals = this->nutrition_table_.totals(items)) {
+            return totals;
+        }
+        const std::uint64_t epoch = this->nutrition_table_.epoch();
+        std::vector<std::string> missing = this->nutrition_table_.missing(items);
+        auto foods = this->getLocalMany(missing);
+        for (std::size_t i = 0; i < missing.size(); i++) {
+            if (!foods[i]) return std::nullopt;
+            this->nutrition_table_.upsert(missing[i], foods[i].unwrap(), epoch);
+        }
+    }
+    return this->nutrition_table_.totals(items);
+}
+
+cc::utils::Result<cc::models::Food> FoodService::fetchOnline(const std::string& barcode) {
+    // only the first caller goes online, the others wait for its result
+    return this->fetches_.run(barcode, [this, &barcode]() {
+        // a flight that just finished may already have saved it
+        cc::utils::Result<cc::models::Food> local = this->repo_->getById_or_Barcode(barcode);
+        if (local) {
+            foodLookups(LookupSource::Storage).inc();
+            return local;
+        }
+        cc::utils::Result<cc::models::Food> fetched = this->off_->getByBarcode(barcode);
+        foodLookups(fetched ? LookupSource::Off : LookupSource::Missing).inc();
+        if (fetched) {
+            // save food in data base so next time will be available no need to look online
+            if (this->repo_->save(fetched.unwrap())) {
+                this->notifyFoodChanged(fetched.unwrap().id());
+            }
+        }
+        return fetched;
+    });
+}
+
 // #todo zed der les cas , bach thkam l program
 cc::utils::Result<void> FoodService::addManualFood(const cc::models::Food& food) {
     cc::utils::Result<void> result = this->repo_->save(food);
+    this->cache_.erase(food.id());
+    this->nutrition_table_.erase(food.id());
     if (result) {
+        this->notifyFoodChanged(food.id());
         return cc::utils::Result<void>::ok();
     } else {
         return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -42,18 +181,58 @@ cc::utils::Result<void> FoodService::addManualFood(const cc::models::Food& food)
     }
 }
 
+cc::utils::Result<void> FoodService::addManualFoods(std::span<const cc::models::Food> foods) {
+    cc::utils::Result<void> result = this->repo_->saveMany(foods);
+    for (const auto& food : foods) {
+        this->cache_.erase(food.id());
+        this->nutrition_table_.erase(food.id());
+    }
+    if (result) {
+        for (const auto& food : foods) {
+            this->notifyFoodChanged(food.id());
+        }
+        return cc::utils::Result<void>::ok();
+    } else {
+        return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                             "can't add Manual Foods");
+    }
+}
+
 cc::utils::Result<void> FoodService::updateFood(const cc::models::Food& food) {
     cc::utils::Result<void> result = this->repo_->upsert(food);
+    this->cache_.erase(food.id());
+    this->nutrition_table_.erase(food.id());
     if (result) {
+        this->notifyFoodChanged(food.id());
         return cc::utils::Result<void>::ok();
     } else {
         return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
                                              "can't add  or update Food");
     }
 }
+cc::utils::Result<void> FoodService::importFoods(std::span<const cc::models::Food> foods) {
+    cc::utils::Result<void> result = this->repo_->upsertMany(foods);
+    for (const auto& food : foods) {
+        this->cache_.erase(food.id());
+        this->nutrition_table_.erase(food.id());
+    }
+    if (result) {
+        for (const auto& food : foods) {
+            this->notifyFoodChanged(food.id());
+        }
+        return cc::utils::Result<void>::ok();
+    } else {
+        return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                             "can't import Foods");
+    }
+}
+
 cc::utils::Result<void> FoodService::deleteFood(const std::string& id) {
     cc::utils::Result<void> result = this->repo_->remove(id);
+    this->cache_.erase(id);
+    this->nutrition_table_.erase(id);
     if (result) {
+        this->notifyFoodChanged(id);
         return cc::utils::Result<void>::ok();
     } else {
         return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -64,7 +243,10 @@ cc::utils::Result<void> FoodService::deleteFood(const std::string& id) {
 cc::utils::Result<void> FoodService::clear_data_base() {
 
     cc::utils::Result<void> result = this->repo_->clear();
+    this->cache_.clear();
+    this->nutrition_table_.clear();
     if (result) {
+        this->notifyFoodChanged("");
         return cc::utils::Result<void>::ok();
     } else {
         return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -81,5 +263,40 @@ cc::utils::Result<std::vector<cc::models::Food>> FoodService::listFoods(int offs
             cc::utils::ErrorCode::NotFound, "can't access, or access is forbiden");
     }
 }
+
+cc::utils::Result<void>
+FoodService::scanFoods(std::size_t batchSize,
+                       const cc::storage::FoodRepository::FoodBatchSink& sink) {
+    return this->repo_->scan(batchSize, sink);
+}
+
+std::uint64_t FoodService::version() const { return this->repo_->version(); }
+
+void FoodService::configureCache(std::size_t budgetBytes, cc::utils::CachePolicy policy) {
+    this->cache_.configure(budgetBytes, policy);
+}
+
+FoodService::FoodCache::Stats FoodService::cacheStats() const {
+    return this->cache_.stats();
+}
+
+std::size_t FoodService::addFoodChangeListener(FoodChangeListener listener) {
+    std::lock_guard<std::mutex> lock(this->listeners_mtx_);
+    std::size_t handle = this->next_listener_++;
+    this->listeners_.emplace_back(handle, std::move(listener));
+    return handle;
+}
+
+void FoodService::removeFoodChangeListener(std::size_t handle) {
+    std::lock_guard<std::mutex> lock(this->listeners_mtx_);
+    std::erase_if(this->listeners_, [handle](const auto& l) { return l.first == handle; });
+}
+
+void FoodService::notifyFoodChanged(const std::string& foodId) {
+    std::lock_guard<std::mutex> lock(this->listeners_mtx_);
+    for (const auto& [handle, listener] : this->listeners_) {
+        listener(foodId);
+    }
+}
 } // namespace services
 } // namespace cc
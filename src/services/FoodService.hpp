@@ -1,10 +1,21 @@
 #pragma once
 #include "clients/OpenFoodFactsClient.hpp"
 #include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "models/nutrition_table.hpp"
 #include "storage/FoodRepository.hpp"
+#include "utils/BoundedCache.hpp"
 #include "utils/Result.hpp"
+#include "utils/SingleFlight.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace cc::storage {
@@ -18,23 +29,70 @@ namespace cc::services {
 
 class FoodService {
   public:
+    using FoodCache = cc::utils::BoundedCache<std::string, cc::models::Food>;
+    static constexpr std::size_t kDefaultCacheBytes = 8 * 1024 * 1024;
+    // called with the id of a food that was added, updated, fetched or
+    // deleted, an empty id means every food changed (data base cleared)
+    using FoodChangeListener = std::function<void(const std::string& foodId)>;
+
     FoodService(std::shared_ptr<cc::storage::FoodRepository> repo,
                 std::shared_ptr<cc::clients::OpenFoodFactsClient> off);
 
     cc::utils::Result<cc::models::Food> getOrFetchByBarcode(const std::string& barcode);
+    // one result per barcode, in the same order: local hits are read in a
+    // single repository pass and the misses are fetched concurrently
+    std::vector<cc::utils::Result<cc::models::Food>>
+    getOrFetchMany(std::span<const std::string> barcodes);
+    // like getOrFetchMany but never goes online, missing foods are NotFound
+    std::vector<cc::utils::Result<cc::models::Food>>
+    getLocalMany(std::span<const std::string> barcodes);
+    // kcal and macros of (foodId, grams) items from the local foods, empty
+    // if one of them is not stored locally
+    std::optional<cc::models::NutritionTotals>
+    nutritionTotals(const std::vector<std::pair<std::string, double>>& items);
 
     cc::utils::Result<void> addManualFood(const cc::models::Food& food);
+    // addManualFood for a batch, written to the repository at once
+    cc::utils::Result<void> addManualFoods(std::span<const cc::models::Food> foods);
     cc::utils::Result<void> updateFood(const cc::models::Food& food);
+    // updateFood for a batch, written to the repository at once
+    cc::utils::Result<void> importFoods(std::span<const cc::models::Food> foods);
     cc::utils::Result<void> deleteFood(const std::string& id);
     cc::utils::Result<void> clear_data_base();
 
     cc::utils::Result<std::vector<cc::models::Food>> listFoods(int offset = 0, int limit = 50);
+    // every stored food in batches of at most batchSize, without loading
+    // them all; sink returns false to stop
+    cc::utils::Result<void> scanFoods(std::size_t batchSize,
+                                      const cc::storage::FoodRepository::FoodBatchSink& sink);
+    // grows with every write to the foods, read without touching storage
+    std::uint64_t version() const;
 
     void setCacheTtlSeconds(int seconds);
+    // decoded foods are kept in memory up to budgetBytes (drops the current cache)
+    void configureCache(std::size_t budgetBytes, cc::utils::CachePolicy policy);
+    FoodCache::Stats cacheStats() const;
+
+    // returns a handle for removeFoodChangeListener
+    std::size_t addFoodChangeListener(FoodChangeListener listener);
+    void removeFoodChangeListener(std::size_t handle);
 
   private:
+    cc::utils::Result<cc::models::Food> fetchOnline(const std::string& barcode);
+    void notifyFoodChanged(const std::string& foodId);
+
     std::shared_ptr<cc::storage::FoodRepository> repo_;
     std::shared_ptr<cc::clients::OpenFoodFactsClient> off_;
+    // one OFF fetch per barcode, concurrent callers share its result
+    cc::utils::SingleFlight<std::string, cc::utils::Result<cc::models::Food>> fetches_;
+    // invalidated on every write, so it never serves a food older than the repository
+    mutable FoodCache cache_{kDefaultCacheBytes};
+    // columnar nutrition values of the foods used by meals, same invalidation as cache_
+    cc::models::NutritionTable nutrition_table_;
+    // held while listeners run, so a removed listener is never called afterwards
+    std::mutex listeners_mtx_;
+    std::vector<std::pair<std::size_t, FoodChangeListener>> listeners_;
+    std::size_t next_listener_{0};
 };
 
 } // namespace cc::services
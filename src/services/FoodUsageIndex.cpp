@@ -0,0 +1,71 @@
+#include "FoodUsageIndex.hpp"
+
+#include <cstdint>
+
+namespace cc {
+namespace services {
+
+void FoodUsageIndex::add(const cc::models::MealLog& meal) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->addLocked(meal);
+}
+
+void FoodUsageIndex::remove(const cc::models::MealLog& meal) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  for (const auto& [food_id, grams] : meal.food_items()) {
+    auto it = this->postings_.find(food_id);
+    if (it == this->postings_.end()) continue;
+    it->second.remove(static_cast<std::uint32_t>(meal.id()));
+    if (it->second.empty()) {
+      this->postings_.erase(it);
+    }
+  }
+}
+
+void FoodUsageIndex::rebuild(const std::vector<cc::models::MealLog>& meals) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->postings_.clear();
+  for (const auto& meal : meals) {
+    this->addLocked(meal);
+  }
+}
+
+void FoodUsageIndex::clear() {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->postings_.clear();
+}
+
+std::vector<int> FoodUsageIndex::mealsUsing(const std::string& foodId) const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::vector<int> ids;
+  auto it = this->postings_.find(foodId);
+  if (it == this->postings_.end()) return ids;
+  for (std::uint32_t id : it->second.values()) {
+    ids.push_back(static_cast<int>(id));
+  }
+  return ids;
+}
+
+std::size_t FoodUsageIndex::foods() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return this->postings_.size();
+}
+
+std::size_t FoodUsageIndex::approximateBytes() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::size_t bytes = sizeof(*this);
+  for (const auto& [food_id, posting] : this->postings_) {
+    bytes += food_id.capacity() + posting.approximateBytes();
+  }
+  return bytes;
+}
+
+void FoodUsageIndex::addLocked(const cc::models::MealLog& meal) {
+  // a meal listing the same food twice is indexed once
+  for (const auto& [food_id, grams] : meal.food_items()) {
+    this->postings_[food_id].add(static_cast<std::uint32_t>(meal.id()));
+  }
+}
+
+}  // namespace services
+}  // namespace cc
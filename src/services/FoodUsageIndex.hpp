@@ -0,0 +1,33 @@
+#pragma once
+#include "models/meal_log.hpp"
+#include "utils/PostingList.hpp"
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cc::services {
+
+// Reverse index food id -> ids of the meals whose items use it, kept up to
+// date by MealService next to the meal repository.
+class FoodUsageIndex {
+  public:
+    void add(const cc::models::MealLog& meal);
+    void remove(const cc::models::MealLog& meal);
+    void rebuild(const std::vector<cc::models::MealLog>& meals);
+    void clear();
+
+    // ascending meal ids, empty if no meal uses the food
+    std::vector<int> mealsUsing(const std::string& foodId) const;
+    std::size_t foods() const;
+    std::size_t approximateBytes() const;
+
+  private:
+    void addLocked(const cc::models::MealLog& meal);
+
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, cc::utils::PostingList> postings_;
+};
+
+} // namespace cc::services
@@ -1,8 +1,11 @@
 #include "MealService.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
 #include <magic_enum.hpp>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "models/food.hpp"
@@ -16,14 +19,35 @@ namespace services {
 MealService::MealService(std::shared_ptr<cc::storage::MealRepository> repo)
     : repo_{repo}
 
-{}
+{
+  this->rebuildIndexes();
+}
+
+MealService::~MealService() {
+  // the resolver may still save foods and trigger a recompute
+  if (this->resolver_) this->resolver_->stop();
+  if (this->foodService_ && this->foodListener_) {
+    this->foodService_->removeFoodChangeListener(*this->foodListener_);
+  }
+}
 
 // #todo zed der les cas , bach thkam l program
 cc::utils::Result<void> MealService::addNewMeal(
     const cc::models::MealLog& meal) {
-  cc::utils::Result<void> result = this->repo_->save(meal);
+  // computed under the lock: a food change then either comes before it or
+  // recomputes the meal once it is in usage_
+  std::unique_lock<std::mutex> lock(this->write_mtx_);
+  cc::models::MealLog stored = meal;
+  stored.setNutrition(this->computeNutrition(meal));
+  cc::utils::Result<void> result = this->repo_->save(stored);
+  if (result) {
+    this->aggregates_.add(stored);
+    this->usage_.add(stored);
+  }
+  lock.unlock();
   // if true food is saved correctly
   if (result) {
+    this->queueFoodItems(meal);
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -31,6 +55,32 @@ cc::utils::Result<void> MealService::addNewMeal(
   }
 }
 
+cc::utils::Result<void> MealService::importMeals(
+    std::span<const cc::models::MealLog> meals) {
+  std::unique_lock<std::mutex> lock(this->write_mtx_);
+  std::vector<cc::models::MealLog> stored(meals.begin(), meals.end());
+  for (auto& meal : stored) {
+    meal.setNutrition(this->computeNutrition(meal));
+  }
+  cc::utils::Result<void> result = this->repo_->saveMany(stored);
+  if (result) {
+    for (const auto& meal : stored) {
+      this->aggregates_.add(meal);
+      this->usage_.add(meal);
+    }
+  }
+  lock.unlock();
+  if (result) {
+    for (const auto& meal : stored) {
+      this->queueFoodItems(meal);
+    }
+    return cc::utils::Result<void>::ok();
+  } else {
+    return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                         "can't import meals");
+  }
+}
+
 cc::utils::Result<std::vector<cc::models::MealLog>> MealService::getByName(
     const std::string& name) {
   std::optional<cc::models::MEALNAME> optional_name =
@@ -89,9 +139,24 @@ cc::utils::Result<std::vector<cc::models::MealLog>> MealService::getByDate(
 
 cc::utils::Result<void> MealService::updateMeal(
     const cc::models::MealLog& meal) {
-  cc::utils::Result<void> result = this->repo_->upsert(meal);
+  std::unique_lock<std::mutex> lock(this->write_mtx_);
+  cc::models::MealLog stored = meal;
+  stored.setNutrition(this->computeNutrition(meal));
+  cc::utils::Result<cc::models::MealLog> previous =
+      this->repo_->getById(meal.id());
+  cc::utils::Result<void> result = this->repo_->upsert(stored);
+  if (result) {
+    if (previous) {
+      this->aggregates_.remove(previous.unwrap());
+      this->usage_.remove(previous.unwrap());
+    }
+    this->aggregates_.add(stored);
+    this->usage_.add(stored);
+  }
+  lock.unlock();
   // if true food is saved correctly
   if (result) {
+    this->queueFoodItems(meal);
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -100,8 +165,14 @@ cc::utils::Result<void> MealService::updateMeal(
 }
 
 cc::utils::Result<void> MealService::deleteMeal(int id) {
+  std::lock_guard<std::mutex> lock(this->write_mtx_);
+  cc::utils::Result<cc::models::MealLog> previous = this->repo_->getById(id);
   cc::utils::Result<void> result = this->repo_->remove(id);
   if (result) {
+    if (previous) {
+      this->aggregates_.remove(previous.unwrap());
+      this->usage_.remove(previous.unwrap());
+    }
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -110,8 +181,11 @@ cc::utils::Result<void> MealService::deleteMeal(int id) {
 }
 
 cc::utils::Result<void> MealService::clear_data_base() {
+  std::lock_guard<std::mutex> lock(this->write_mtx_);
   cc::utils::Result<void> result = this->repo_->clear();
   if (result) {
+    this->aggregates_.clear();
+    this->usage_.clear();
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -131,5 +205,155 @@ cc::utils::Result<std::vector<cc::models::MealLog>> MealService::listMeals(
   }
 }
 
+cc::utils::Result<void> MealService::scanMeals(
+    std::chrono::sys_days from, std::chrono::sys_days to, std::size_t batchSize,
+    const cc::storage::MealRepository::MealBatchSink &sink) {
+  return this->repo_->scanRange(from, to, batchSize, sink);
+}
+
+cc::utils::Result<void> MealService::scanMeals(
+    std::size_t batchSize,
+    const cc::storage::MealRepository::MealBatchSink &sink) {
+  return this->repo_->scan(batchSize, sink);
+}
+
+void MealService::setFoodResolver(std::shared_ptr<FoodResolver> resolver) {
+  this->resolver_ = resolver;
+}
+
+std::shared_ptr<FoodResolver> MealService::foodResolver() const {
+  return this->resolver_;
+}
+
+void MealService::queueFoodItems(const cc::models::MealLog& meal) {
+  if (!this->resolver_) return;
+  std::vector<std::string> ids;
+  for (const auto& [food_id, grams] : meal.food_items()) {
+    ids.push_back(food_id);
+  }
+  this->resolver_->enqueue(ids);
+}
+
+std::uint64_t MealService::version() const { return this->repo_->version(); }
+
+std::uint64_t MealService::dayVersion(std::chrono::sys_days day) const {
+  return this->aggregates_.dayVersion(day);
+}
+
+cc::utils::Result<DailyTotals> MealService::dailyTotals(
+    int day, int month, int year, std::uint64_t* version) const {
+  const std::chrono::year_month_day ymd{
+      std::chrono::year{year}, std::chrono::month{static_cast<unsigned>(month)},
+      std::chrono::day{static_cast<unsigned>(day)}};
+  if (!ymd.ok()) {
+    return cc::utils::Result<DailyTotals>::fail(cc::utils::ErrorCode::NotFound,
+                                                "wrong date format");
+  }
+  return cc::utils::Result<DailyTotals>::ok(
+      this->aggregates_.get(std::chrono::sys_days{ymd}, version));
+}
+
+std::vector<PeriodTotals> MealService::periodTotals(
+    std::chrono::sys_days from, std::chrono::sys_days to,
+    Granularity granularity) const {
+  return this->aggregates_.periods(from, to, granularity);
+}
+
+std::vector<SeriesPoint> MealService::series(std::chrono::sys_days from,
+                                            std::chrono::sys_days to,
+                                            std::size_t points) const {
+  return this->aggregates_.series(from, to, points);
+}
+
+void MealService::rebuildIndexes() {
+  std::lock_guard<std::mutex> lock(this->write_mtx_);
+  auto meals = this->repo_->list(0, std::numeric_limits<int>::max());
+  const std::vector<cc::models::MealLog> all =
+      meals ? meals.unwrap() : std::vector<cc::models::MealLog>{};
+  this->aggregates_.rebuild(all);
+  this->usage_.rebuild(all);
+}
+
+std::vector<int> MealService::mealsUsingFood(const std::string& foodId) const {
+  return this->usage_.mealsUsing(foodId);
+}
+
+std::size_t MealService::addMealsInvalidatedListener(
+    MealsInvalidatedListener listener) {
+  std::lock_guard<std::mutex> lock(this->listeners_mtx_);
+  std::size_t handle = this->next_listener_++;
+  this->listeners_.emplace_back(handle, std::move(listener));
+  return handle;
+}
+
+void MealService::removeMealsInvalidatedListener(std::size_t handle) {
+  std::lock_guard<std::mutex> lock(this->listeners_mtx_);
+  std::erase_if(this->listeners_,
+                [handle](const auto& l) { return l.first == handle; });
+}
+
+void MealService::setFoodService(std::shared_ptr<FoodService> foodService) {
+  if (this->foodService_ && this->foodListener_) {
+    this->foodService_->removeFoodChangeListener(*this->foodListener_);
+    this->foodListener_.reset();
+  }
+  this->foodService_ = foodService;
+  if (this->foodService_) {
+    this->foodListener_ = this->foodService_->addFoodChangeListener(
+        [this](const std::string& foodId) { this->recomputeNutrition(foodId); });
+    // fills in totals of meals stored before their foods were known
+    this->recomputeNutrition("");
+  }
+}
+
+std::optional<cc::models::NutritionTotals> MealService::computeNutrition(
+    const cc::models::MealLog& meal) {
+  if (!this->foodService_) return std::nullopt;
+  // local only: writes never wait for OpenFoodFacts, the resolver fetches
+  // the missing foods and the recompute fills the totals in afterwards
+  return this->foodService_->nutritionTotals(meal.food_items());
+}
+
+void MealService::recomputeNutrition(const std::string& foodId) {
+  std::vector<int> affected;
+  {
+    std::lock_guard<std::mutex> lock(this->write_mtx_);
+    // only the meals the reverse index knows to use the food, read in a
+    // single pass over the repository (every meal for an empty foodId)
+    std::vector<cc::models::MealLog> meals;
+    if (foodId.empty()) {
+      auto all = this->repo_->list(0, std::numeric_limits<int>::max());
+      if (all) meals = all.unwrap();
+    } else if (const std::vector<int> ids = this->usage_.mealsUsing(foodId);
+               !ids.empty()) {
+      auto found = this->repo_->getMany(ids);
+      if (found) meals = found.unwrap();
+    }
+    // the changed meals are written back together, one repository write
+    std::vector<std::size_t> changed;
+    std::vector<cc::models::MealLog> updated;
+    for (std::size_t i = 0; i < meals.size(); i++) {
+      affected.push_back(meals[i].id());
+      auto nutrition = this->computeNutrition(meals[i]);
+      if (nutrition != meals[i].nutrition()) {
+        changed.push_back(i);
+        updated.push_back(meals[i]);
+        updated.back().setNutrition(nutrition);
+      }
+    }
+    if (!updated.empty() && this->repo_->upsertMany(updated)) {
+      for (std::size_t u = 0; u < updated.size(); u++) {
+        this->aggregates_.remove(meals[changed[u]]);
+        this->aggregates_.add(updated[u]);
+      }
+    }
+  }
+  if (affected.empty()) return;
+  std::lock_guard<std::mutex> lock(this->listeners_mtx_);
+  for (const auto& [handle, listener] : this->listeners_) {
+    listener(foodId, affected);
+  }
+}
+
 }  // namespace services
 }  // namespace cc
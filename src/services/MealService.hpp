@@ -2,11 +2,23 @@
 #include "clients/OpenFoodFactsClient.hpp"
 #include "models/food.hpp"
 #include "models/meal_log.hpp"
+#include "services/DailyAggregateStore.hpp"
+#include "services/FoodResolver.hpp"
+#include "services/FoodService.hpp"
+#include "services/FoodUsageIndex.hpp"
 #include "storage/FoodRepository.hpp"
 #include "storage/MealRepository.hpp"
 #include "utils/Result.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace cc::storage {
@@ -17,7 +29,13 @@ namespace cc::services {
 
 class MealService {
 public:
+  // called after a food change with the ids of the meals using that food
+  // (foodId empty: every meal), for data derived from those meals
+  using MealsInvalidatedListener = std::function<void(
+      const std::string &foodId, const std::vector<int> &mealIds)>;
+
   MealService(std::shared_ptr<cc::storage::MealRepository> repo);
+  ~MealService();
 
   cc::utils::Result<std::vector<cc::models::MealLog>>
   getByName(const std::string &name);
@@ -26,14 +44,80 @@ public:
   cc::utils::Result<cc::models::MealLog>
   getById(int id);
   cc::utils::Result<void> addNewMeal(const cc::models::MealLog &meal);
+  // addNewMeal for a batch, written to the repository at once
+  cc::utils::Result<void> importMeals(std::span<const cc::models::MealLog> meals);
   cc::utils::Result<void> updateMeal(const cc::models::MealLog &meal);
   cc::utils::Result<void> deleteMeal(int id);
   cc::utils::Result<void> clear_data_base();
   cc::utils::Result<std::vector<cc::models::MealLog>> listMeals(int offset = 0,
                                                                 int limit = 50);
+  // meals of the UTC days from..to in batches of at most batchSize, without
+  // loading them all; sink returns false to stop
+  cc::utils::Result<void>
+  scanMeals(std::chrono::sys_days from, std::chrono::sys_days to,
+            std::size_t batchSize,
+            const cc::storage::MealRepository::MealBatchSink &sink);
+  // every meal, the same way
+  cc::utils::Result<void>
+  scanMeals(std::size_t batchSize,
+            const cc::storage::MealRepository::MealBatchSink &sink);
+
+  // optional: food ids of written meals are resolved in the background
+  void setFoodResolver(std::shared_ptr<FoodResolver> resolver);
+  std::shared_ptr<FoodResolver> foodResolver() const;
+
+  // optional: meal nutrition is computed on write from the local foods and
+  // recomputed when one of the referenced foods changes
+  void setFoodService(std::shared_ptr<FoodService> foodService);
+
+  // grow with every write, read without touching storage: version() for
+  // any meal, dayVersion() for the totals of that UTC day (bumped with
+  // them, after the repository write)
+  std::uint64_t version() const;
+  std::uint64_t dayVersion(std::chrono::sys_days day) const;
+
+  // kept up to date on every write, reading a day does not touch the
+  // repository; version gets the dayVersion() of these totals
+  cc::utils::Result<DailyTotals> dailyTotals(int day, int month, int year,
+                                             std::uint64_t* version = nullptr) const;
+  // per day, week or month totals of from..to, O(log n) per period
+  std::vector<PeriodTotals> periodTotals(std::chrono::sys_days from,
+                                         std::chrono::sys_days to,
+                                         Granularity granularity) const;
+  // at most `points` buckets covering from..to, for charts
+  std::vector<SeriesPoint> series(std::chrono::sys_days from,
+                                  std::chrono::sys_days to,
+                                  std::size_t points) const;
+  // ascending ids of the meals whose items use the food
+  std::vector<int> mealsUsingFood(const std::string &foodId) const;
+  std::size_t addMealsInvalidatedListener(MealsInvalidatedListener listener);
+  void removeMealsInvalidatedListener(std::size_t handle);
+
+  // re-reads every meal into the day aggregates and the food usage index,
+  // e.g. after the repository was changed externally
+  void rebuildIndexes();
 
 private:
+  void queueFoodItems(const cc::models::MealLog &meal);
+  // empty when there is no food service or a food is not stored locally yet;
+  // writers call it holding write_mtx_, so recomputeNutrition sees the meal
+  std::optional<cc::models::NutritionTotals>
+  computeNutrition(const cc::models::MealLog &meal);
+  // foodId empty: every meal
+  void recomputeNutrition(const std::string &foodId);
+
   std::shared_ptr<cc::storage::MealRepository> repo_;
+  std::shared_ptr<FoodResolver> resolver_;
+  std::shared_ptr<FoodService> foodService_;
+  std::optional<std::size_t> foodListener_;
+  DailyAggregateStore aggregates_;
+  FoodUsageIndex usage_;
+  std::mutex listeners_mtx_;
+  std::vector<std::pair<std::size_t, MealsInvalidatedListener>> listeners_;
+  std::size_t next_listener_{0};
+  // serializes meal writes with nutrition recomputes, so a recompute never
+  // writes back a meal that was changed meanwhile
+  std::mutex write_mtx_;
 };
 
 } // namespace cc::services
@@ -1,10 +1,14 @@
 #pragma once
 #include "models/food.hpp"
 #include "utils/Result.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,18 +16,36 @@ namespace cc::storage {
 
 class FoodRepository {
   public:
+    // gets the next foods of a scan, returns false to stop it
+    using FoodBatchSink = std::function<bool(std::span<cc::models::Food> foods)>;
+
     virtual ~FoodRepository() = default;
 
     virtual cc::utils::Result<void> save(const cc::models::Food& food) = 0;
+    // save of every food with a single read and write of the storage; foods
+    // already stored (or earlier in the batch) are left as they are
+    virtual cc::utils::Result<void> saveMany(std::span<const cc::models::Food> foods) = 0;
     virtual cc::utils::Result<cc::models::Food> getById_or_Barcode(const std::string& id) = 0;
+    // all foods whose id is in ids, read in a single pass (missing ids are skipped)
+    virtual cc::utils::Result<std::vector<cc::models::Food>>
+    getMany(std::span<const std::string> ids) = 0;
     virtual cc::utils::Result<std::vector<cc::models::Food>> list(int offset = 0,
                                                                   int limit = 50) = 0;
     virtual cc::utils::Result<void> remove(const std::string& id) = 0;
 
     // update or insert if doesn't exist
     virtual cc::utils::Result<void> upsert(const cc::models::Food& food) = 0;
+    // upsert of every food with a single read and write of the storage
+    virtual cc::utils::Result<void> upsertMany(std::span<const cc::models::Food> foods) = 0;
     // clear all records
     virtual cc::utils::Result<void> clear() = 0;
+
+    // every food in storage order, passed to sink in batches of at most
+    // batchSize; reads a snapshot, so the sink may use the repository
+    virtual cc::utils::Result<void> scan(std::size_t batchSize, const FoodBatchSink& sink) = 0;
+
+    // grows with every successful write, kept in memory (no storage access)
+    virtual std::uint64_t version() const = 0;
 };
 
 } // namespace cc::storage
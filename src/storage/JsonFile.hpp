@@ -0,0 +1,75 @@
+#pragma once
+#include "nlohmann/json.hpp"
+#include "utils/Result.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace cc::storage {
+
+// Helpers of the JSON file repositories, which store one array per file.
+
+// writes content next to path and renames it over the file, so readers
+// never see a partly written file and open streams keep the old version;
+// false if it could not be written
+inline bool replaceJsonFile(const std::string& path, const nlohmann::json& content) {
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream o(tmp_path);
+    if (!o.is_open()) return false;
+    o << content.dump(4) << std::endl;
+    o.close();
+    std::error_code ec;
+    // a short write (disk full) must not replace the good file
+    if (o.fail()) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    std::filesystem::rename(tmp_path, path, ec);
+    return !ec;
+}
+
+// Decodes the elements of the array one at a time and passes those keep()
+// accepts to sink in batches of at most batchSize; each element is
+// discarded once decoded, the document is never built. sink returns false
+// to stop.
+//   keep: bool(const nlohmann::json& element)
+//   sink: bool(std::span<Record>)
+template <typename Record, typename Keep, typename Sink>
+cc::utils::Result<void> scanJsonArray(std::istream& in, std::size_t batchSize, Keep&& keep,
+                                      Sink&& sink) {
+    using parse_event_t = nlohmann::json::parse_event_t;
+    if (in.peek() == std::istream::traits_type::eof()) {
+        return cc::utils::Result<void>::ok();
+    }
+    batchSize = std::max<std::size_t>(1, batchSize);
+    std::vector<Record> batch;
+    batch.reserve(batchSize);
+    bool stopped = false;
+    auto flush = [&]() {
+        if (!batch.empty() && !stopped) stopped = !sink(std::span<Record>(batch));
+        batch.clear();
+    };
+    try {
+        // the records go to the sink, the callback prunes them from the
+        // document; a (void) cast doesn't silence GCC's warn_unused_result
+        [[maybe_unused]] const nlohmann::json pruned = nlohmann::json::parse(in, [&](int depth, parse_event_t event, nlohmann::json& parsed) {
+            if (depth != 1 || event != parse_event_t::object_end) return true;
+            if (!stopped && keep(parsed)) {
+                batch.push_back(parsed.get<Record>());
+                if (batch.size() == batchSize) flush();
+            }
+            return false;
+        });
+    } catch (const nlohmann::json::exception& e) {
+        return cc::utils::Result<void>::fail(cc::utils::ErrorCode::ParseError, e.what());
+    }
+    flush();
+    return cc::utils::Result<void>::ok();
+}
+
+} // namespace cc::storage
@@ -1,9 +1,16 @@
 #include "storage/JsonFoodRepository.hpp"
 
+#include "storage/JsonFile.hpp"
+#include "storage/StorageTimer.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
 namespace cc::storage {
 JsonFoodRepository::JsonFoodRepository(std::string filePath)
     : filePath_{filePath} {}
 cc::utils::Result<void> JsonFoodRepository::save(const cc::models::Food &food) {
+  StorageTimer timer{"foods", "save"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(filePath_);
   nlohmann::json file_content;
@@ -20,10 +27,42 @@ cc::utils::Result<void> JsonFoodRepository::save(const cc::models::Food &food) {
     }
   }
   file_content.push_back(food);
-  std::ofstream o(filePath_);
-  if (o.is_open()) {
-    o << file_content.dump(4) << std::endl;
-    o.close();
+  if (this->writeFile(file_content)) {
+    this->versions_.bump();
+    return cc::utils::Result<void>::ok();
+  } else {
+    return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                         "can't open file");
+  }
+}
+
+cc::utils::Result<void>
+JsonFoodRepository::saveMany(std::span<const cc::models::Food> foods) {
+  StorageTimer timer{"foods", "saveMany"};
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::ifstream infile(this->filePath_);
+  nlohmann::json file_content = nlohmann::json::array();
+  if (infile.is_open() && infile.peek() != std::ifstream::traits_type::eof()) {
+    infile >> file_content;
+    infile.close();
+  }
+  std::unordered_set<std::string> stored;
+  for (const auto &item : file_content) {
+    stored.insert(item["id"].get<std::string>());
+  }
+  std::size_t added = 0;
+  for (const auto &food : foods) {
+    // like save, a stored id is kept as it is
+    if (stored.insert(food.id()).second) {
+      file_content.push_back(food);
+      added++;
+    }
+  }
+  if (added == 0) {
+    return cc::utils::Result<void>::ok();
+  }
+  if (this->writeFile(file_content)) {
+    this->versions_.bump();
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -33,6 +72,7 @@ cc::utils::Result<void> JsonFoodRepository::save(const cc::models::Food &food) {
 
 cc::utils::Result<cc::models::Food>
 JsonFoodRepository::getById_or_Barcode(const std::string &id) {
+  StorageTimer timer{"foods", "getById_or_Barcode"};
 
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
@@ -54,8 +94,34 @@ JsonFoodRepository::getById_or_Barcode(const std::string &id) {
   }
 }
 
+cc::utils::Result<std::vector<cc::models::Food>>
+JsonFoodRepository::getMany(std::span<const std::string> ids) {
+  StorageTimer timer{"foods", "getMany"};
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::ifstream infile(this->filePath_);
+  nlohmann::json file_content;
+  if (infile.is_open() && infile.peek() != std::ifstream::traits_type::eof()) {
+    infile >> file_content;
+    infile.close();
+    std::unordered_set<std::string> wanted(ids.begin(), ids.end());
+    std::vector<cc::models::Food> food_vector;
+    for (const auto &i : file_content) {
+      if (wanted.erase(i["id"].get<std::string>()) > 0) {
+        food_vector.push_back(cc::models::Food(i));
+        if (wanted.empty()) break;
+      }
+    }
+    return cc::utils::Result<std::vector<cc::models::Food>>::ok(food_vector);
+  } else {
+    return cc::utils::Result<std::vector<cc::models::Food>>::fail(
+        cc::utils::ErrorCode::NotFound,
+        "file is empty , or can't open that file");
+  }
+}
+
 cc::utils::Result<std::vector<cc::models::Food>>
 JsonFoodRepository::list(int offset, int limit) {
+  StorageTimer timer{"foods", "list"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -74,6 +140,7 @@ JsonFoodRepository::list(int offset, int limit) {
   }
 }
 cc::utils::Result<void> JsonFoodRepository::remove(const std::string &id) {
+  StorageTimer timer{"foods", "remove"};
 
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
@@ -84,11 +151,8 @@ cc::utils::Result<void> JsonFoodRepository::remove(const std::string &id) {
     for (int i = 0; i < file_content.size(); i++) {
       if (file_content[i]["id"].get<std::string>() == id) {
         file_content.erase(i);
-        std::ofstream o(this->filePath_);
-        if (o.is_open()) {
-          o.clear();
-          o << file_content.dump(4) << std::endl;
-          o.close();
+        if (this->writeFile(file_content)) {
+          this->versions_.bump();
           return cc::utils::Result<void>::ok();
         } else {
           return cc::utils::Result<void>::fail(
@@ -109,6 +173,7 @@ cc::utils::Result<void> JsonFoodRepository::remove(const std::string &id) {
 // update or insert if doesn't exist
 cc::utils::Result<void>
 JsonFoodRepository::upsert(const cc::models::Food &food) {
+  StorageTimer timer{"foods", "upsert"};
 
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
@@ -126,11 +191,8 @@ JsonFoodRepository::upsert(const cc::models::Food &food) {
     if (!item_updated) {
       file_content.push_back(food);
     }
-    std::ofstream o(this->filePath_);
-    if (o.is_open()) {
-      o.clear();
-      o << file_content.dump(4) << std::endl;
-      o.close();
+    if (this->writeFile(file_content)) {
+      this->versions_.bump();
       return cc::utils::Result<void>::ok();
     } else {
       return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -143,16 +205,44 @@ JsonFoodRepository::upsert(const cc::models::Food &food) {
   }
 }
 
+cc::utils::Result<void>
+JsonFoodRepository::upsertMany(std::span<const cc::models::Food> foods) {
+  StorageTimer timer{"foods", "upsertMany"};
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::ifstream infile(this->filePath_);
+  nlohmann::json file_content = nlohmann::json::array();
+  if (infile.is_open() && infile.peek() != std::ifstream::traits_type::eof()) {
+    infile >> file_content;
+    infile.close();
+  }
+  // position of every stored id, so the batch costs one pass
+  std::unordered_map<std::string, std::size_t> positions;
+  for (std::size_t i = 0; i < file_content.size(); i++) {
+    positions.emplace(file_content[i]["id"].get<std::string>(), i);
+  }
+  for (const auto &food : foods) {
+    auto [it, inserted] = positions.emplace(food.id(), file_content.size());
+    if (inserted) {
+      file_content.push_back(food);
+    } else {
+      file_content[it->second] = food;
+    }
+  }
+  if (this->writeFile(file_content)) {
+    this->versions_.bump();
+    return cc::utils::Result<void>::ok();
+  } else {
+    return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                         "can't update or insert items");
+  }
+}
+
 // clear all records
 cc::utils::Result<void> JsonFoodRepository::clear() {
+  StorageTimer timer{"foods", "clear"};
   std::lock_guard<std::mutex> lock(this->mtx_);
-  std::ofstream o(this->filePath_);
-  if (o.is_open()) {
-    o.clear();
-
-    nlohmann::json empty_json = nlohmann::json::array();
-    o << empty_json.dump(4) << std::endl;
-    o.close();
+  if (this->writeFile(nlohmann::json::array())) {
+    this->versions_.bumpAll();
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -160,4 +250,30 @@ cc::utils::Result<void> JsonFoodRepository::clear() {
   }
 }
 
+cc::utils::Result<void> JsonFoodRepository::scan(std::size_t batchSize,
+                                                 const FoodBatchSink &sink) {
+  StorageTimer timer{"foods", "scan"};
+  std::ifstream infile;
+  {
+    // writers replace the file, the open stream keeps reading this version
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    infile.open(this->filePath_);
+  }
+  if (!infile.is_open()) {
+    return cc::utils::Result<void>::fail(
+        cc::utils::ErrorCode::NotFound,
+        "file is empty , or can't open that file");
+  }
+  return scanJsonArray<cc::models::Food>(
+      infile, batchSize, [](const nlohmann::json &) { return true; }, sink);
+}
+
+bool JsonFoodRepository::writeFile(const nlohmann::json &content) {
+  return replaceJsonFile(this->filePath_, content);
+}
+
+std::uint64_t JsonFoodRepository::version() const {
+  return this->versions_.collection();
+}
+
 } // namespace cc::storage
@@ -1,6 +1,7 @@
 #pragma once
 #include "nlohmann/json.hpp"
 #include "storage/FoodRepository.hpp"
+#include "storage/VersionCounters.hpp"
 #include <mutex>
 #include <string>
 
@@ -11,16 +12,26 @@ class JsonFoodRepository : public FoodRepository {
     explicit JsonFoodRepository(std::string filePath);
 
     cc::utils::Result<void> save(const cc::models::Food& food) override;
+    cc::utils::Result<void> saveMany(std::span<const cc::models::Food> foods) override;
     cc::utils::Result<cc::models::Food> getById_or_Barcode(const std::string& id) override;
+    cc::utils::Result<std::vector<cc::models::Food>>
+    getMany(std::span<const std::string> ids) override;
     cc::utils::Result<std::vector<cc::models::Food>> list(int offset = 0, int limit = 50) override;
     cc::utils::Result<void> remove(const std::string& id) override;
 
     // update or insert if doesn't exist
     cc::utils::Result<void> upsert(const cc::models::Food& food) override;
+    cc::utils::Result<void> upsertMany(std::span<const cc::models::Food> foods) override;
 
     // clear all records
     cc::utils::Result<void> clear() override;
 
+    // streams the file: only the current food and one batch are in memory,
+    // and the lock is only held to open it
+    cc::utils::Result<void> scan(std::size_t batchSize, const FoodBatchSink& sink) override;
+
+    std::uint64_t version() const override;
+
     // remove copy and assign because mutex is not copyable
     // but allowing move construtor
     JsonFoodRepository(const JsonFoodRepository&) = delete;
@@ -30,8 +41,12 @@ class JsonFoodRepository : public FoodRepository {
     JsonFoodRepository& operator=(JsonFoodRepository&&) noexcept = default;
 
   private:
+    // replaces the file atomically, false if it could not be written
+    bool writeFile(const nlohmann::json& content);
+
     std::string filePath_;
     mutable std::mutex mtx_;
+    VersionCounters versions_;
 };
 
 } // namespace cc::storage
@@ -6,8 +6,13 @@
 #include <cmath>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "models/meal_log.hpp"
+#include "storage/JsonFile.hpp"
+#include "storage/StorageTimer.hpp"
 #include "utils/date_time_utils.hpp"
 
 namespace cc::storage {
@@ -40,6 +45,7 @@ cc::utils::Result<void> JsonMealRepository::sync_meals_id() {
 
 cc::utils::Result<void> JsonMealRepository::save(
     const cc::models::MealLog& meal) {
+  StorageTimer timer{"meals", "save"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(filePath_);
   nlohmann::json file_content;
@@ -50,10 +56,9 @@ cc::utils::Result<void> JsonMealRepository::save(
     file_content = nlohmann::json::array();
   }
   file_content.push_back(meal);
-  std::ofstream o(filePath_);
-  if (o.is_open()) {
-    o << file_content.dump(4) << std::endl;
-    o.close();
+  if (this->writeFile(file_content)) {
+    this->versions_.bumpDay(
+        std::chrono::floor<std::chrono::days>(meal.gettime()));
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -61,8 +66,61 @@ cc::utils::Result<void> JsonMealRepository::save(
   }
 }
 
+cc::utils::Result<void> JsonMealRepository::saveMany(
+    std::span<const cc::models::MealLog> meals) {
+  StorageTimer timer{"meals", "saveMany"};
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::ifstream infile(filePath_);
+  nlohmann::json file_content;
+  if (infile.is_open() && infile.peek() != std::ifstream::traits_type::eof()) {
+    infile >> file_content;
+    infile.close();
+  } else {
+    file_content = nlohmann::json::array();
+  }
+  for (const auto& meal : meals) {
+    file_content.push_back(meal);
+  }
+  if (this->writeFile(file_content)) {
+    for (const auto& meal : meals) {
+      this->versions_.bumpDay(
+          std::chrono::floor<std::chrono::days>(meal.gettime()));
+    }
+    return cc::utils::Result<void>::ok();
+  } else {
+    return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                         "can't open file");
+  }
+}
+
+cc::utils::Result<std::vector<cc::models::MealLog>>
+JsonMealRepository::getMany(std::span<const int> ids) {
+  StorageTimer timer{"meals", "getMany"};
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::ifstream infile(this->filePath_);
+  nlohmann::json file_content;
+  if (infile.is_open() && infile.peek() != std::ifstream::traits_type::eof()) {
+    infile >> file_content;
+    infile.close();
+    std::unordered_set<int> wanted(ids.begin(), ids.end());
+    std::vector<cc::models::MealLog> meal_vector;
+    for (const auto& i : file_content) {
+      if (wanted.erase(i["id"].get<int>()) > 0) {
+        meal_vector.push_back(cc::models::MealLog(i));
+        if (wanted.empty()) break;
+      }
+    }
+    return cc::utils::Result<std::vector<cc::models::MealLog>>::ok(meal_vector);
+  } else {
+    return cc::utils::Result<std::vector<cc::models::MealLog>>::fail(
+        cc::utils::ErrorCode::NotFound,
+        "file is empty , or can't open that file");
+  }
+}
+
 cc::utils::Result<cc::models::MealLog> JsonMealRepository::getById(
     const int id) {
+  StorageTimer timer{"meals", "getById"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -86,6 +144,7 @@ cc::utils::Result<cc::models::MealLog> JsonMealRepository::getById(
 
 cc::utils::Result<std::vector<cc::models::MealLog>>
 JsonMealRepository::getByDate(std::chrono::system_clock::time_point tsUtc) {
+  StorageTimer timer{"meals", "getByDate"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -113,6 +172,7 @@ JsonMealRepository::getByDate(std::chrono::system_clock::time_point tsUtc) {
 
 cc::utils::Result<std::vector<cc::models::MealLog>>
 JsonMealRepository::getByName(cc::models::MEALNAME name) {
+  StorageTimer timer{"meals", "getByName"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -139,6 +199,7 @@ JsonMealRepository::getByName(cc::models::MEALNAME name) {
 
 cc::utils::Result<std::vector<cc::models::MealLog>> JsonMealRepository::list(
     int offset, int limit) {
+  StorageTimer timer{"meals", "list"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -164,6 +225,7 @@ cc::utils::Result<std::vector<cc::models::MealLog>> JsonMealRepository::list(
   }
 }
 cc::utils::Result<void> JsonMealRepository::remove(const int id) {
+  StorageTimer timer{"meals", "remove"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -172,12 +234,11 @@ cc::utils::Result<void> JsonMealRepository::remove(const int id) {
     infile.close();
     for (int i = 0; i < file_content.size(); i++) {
       if (file_content[i]["id"].get<int>() == id) {
+        const auto day = std::chrono::floor<std::chrono::days>(
+            cc::utils::fromIso8601(file_content[i]["tsUtc"].get<std::string>()));
         file_content.erase(i);
-        std::ofstream o(this->filePath_);
-        if (o.is_open()) {
-          o.clear();
-          o << file_content.dump(4) << std::endl;
-          o.close();
+        if (this->writeFile(file_content)) {
+          this->versions_.bumpDay(day);
           return cc::utils::Result<void>::ok();
         } else {
           return cc::utils::Result<void>::fail(
@@ -198,6 +259,7 @@ cc::utils::Result<void> JsonMealRepository::remove(const int id) {
 // update or insert if doesn't exist
 cc::utils::Result<void> JsonMealRepository::upsert(
     const cc::models::MealLog& meal) {
+  StorageTimer timer{"meals", "upsert"};
   std::lock_guard<std::mutex> lock(this->mtx_);
   std::ifstream infile(this->filePath_);
   nlohmann::json file_content;
@@ -205,9 +267,14 @@ cc::utils::Result<void> JsonMealRepository::upsert(
     infile >> file_content;
     infile.close();
     bool item_updated = false;
+    // a meal moved to another day changes both days
+    std::vector<std::chrono::sys_days> days{
+        std::chrono::floor<std::chrono::days>(meal.gettime())};
     for (int i = 0; i < file_content.size(); i++) {
       // pay attention to this comparison
       if (file_content[i]["id"].get<int>() == meal.id()) {
+        days.push_back(std::chrono::floor<std::chrono::days>(
+            cc::utils::fromIso8601(file_content[i]["tsUtc"].get<std::string>())));
         file_content[i] = meal;
         item_updated = true;
       }
@@ -215,11 +282,10 @@ cc::utils::Result<void> JsonMealRepository::upsert(
     if (!item_updated) {
       file_content.push_back(meal);
     }
-    std::ofstream o(this->filePath_);
-    if (o.is_open()) {
-      o.clear();
-      o << file_content.dump(4) << std::endl;
-      o.close();
+    if (this->writeFile(file_content)) {
+      for (const auto& day : days) {
+        this->versions_.bumpDay(day);
+      }
       return cc::utils::Result<void>::ok();
     } else {
       return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -231,16 +297,51 @@ cc::utils::Result<void> JsonMealRepository::upsert(
   }
 }
 
+cc::utils::Result<void> JsonMealRepository::upsertMany(
+    std::span<const cc::models::MealLog> meals) {
+  StorageTimer timer{"meals", "upsertMany"};
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::ifstream infile(this->filePath_);
+  nlohmann::json file_content = nlohmann::json::array();
+  if (infile.is_open() && infile.peek() != std::ifstream::traits_type::eof()) {
+    infile >> file_content;
+    infile.close();
+  }
+  // position of every stored id, so the batch costs one pass
+  std::unordered_map<int, std::size_t> positions;
+  for (std::size_t i = 0; i < file_content.size(); i++) {
+    positions.emplace(file_content[i]["id"].get<int>(), i);
+  }
+  // a meal moved to another day changes both days
+  std::vector<std::chrono::sys_days> days;
+  for (const auto& meal : meals) {
+    days.push_back(std::chrono::floor<std::chrono::days>(meal.gettime()));
+    auto [it, inserted] = positions.emplace(meal.id(), file_content.size());
+    if (inserted) {
+      file_content.push_back(meal);
+    } else {
+      days.push_back(std::chrono::floor<std::chrono::days>(cc::utils::fromIso8601(
+          file_content[it->second]["tsUtc"].get<std::string>())));
+      file_content[it->second] = meal;
+    }
+  }
+  if (this->writeFile(file_content)) {
+    for (const auto& day : days) {
+      this->versions_.bumpDay(day);
+    }
+    return cc::utils::Result<void>::ok();
+  } else {
+    return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
+                                         "can't update or insert items");
+  }
+}
+
 // clear all records
 cc::utils::Result<void> JsonMealRepository::clear() {
+  StorageTimer timer{"meals", "clear"};
   std::lock_guard<std::mutex> lock(this->mtx_);
-  std::ofstream o(this->filePath_);
-  if (o.is_open()) {
-    o.clear();
-
-    nlohmann::json empty_json = nlohmann::json::array();
-    o << empty_json.dump(4) << std::endl;
-    o.close();
+  if (this->writeFile(nlohmann::json::array())) {
+    this->versions_.bumpAll();
     return cc::utils::Result<void>::ok();
   } else {
     return cc::utils::Result<void>::fail(cc::utils::ErrorCode::StorageError,
@@ -248,4 +349,55 @@ cc::utils::Result<void> JsonMealRepository::clear() {
   }
 }
 
+cc::utils::Result<void> JsonMealRepository::scan(std::size_t batchSize,
+                                                 const MealBatchSink& sink) {
+  StorageTimer timer{"meals", "scan"};
+  std::ifstream infile = this->openSnapshot();
+  if (!infile.is_open()) {
+    return cc::utils::Result<void>::fail(
+        cc::utils::ErrorCode::NotFound,
+        "file is empty , or can't open that file");
+  }
+  return scanJsonArray<cc::models::MealLog>(
+      infile, batchSize, [](const nlohmann::json&) { return true; }, sink);
+}
+
+cc::utils::Result<void> JsonMealRepository::scanRange(
+    std::chrono::sys_days from, std::chrono::sys_days to,
+    std::size_t batchSize, const MealBatchSink& sink) {
+  StorageTimer timer{"meals", "scanRange"};
+  std::ifstream infile = this->openSnapshot();
+  if (!infile.is_open()) {
+    return cc::utils::Result<void>::fail(
+        cc::utils::ErrorCode::NotFound,
+        "file is empty , or can't open that file");
+  }
+  // the day is checked before the meal is decoded
+  auto inRange = [&](const nlohmann::json& meal) {
+    if (!meal.contains("tsUtc")) return false;
+    const auto day = std::chrono::floor<std::chrono::days>(
+        cc::utils::fromIso8601(meal["tsUtc"].get<std::string>()));
+    return day >= from && day <= to;
+  };
+  return scanJsonArray<cc::models::MealLog>(infile, batchSize, inRange, sink);
+}
+
+std::ifstream JsonMealRepository::openSnapshot() const {
+  // writers replace the file, the open stream keeps reading this version
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return std::ifstream(this->filePath_);
+}
+
+bool JsonMealRepository::writeFile(const nlohmann::json& content) {
+  return replaceJsonFile(this->filePath_, content);
+}
+
+std::uint64_t JsonMealRepository::version() const {
+  return this->versions_.collection();
+}
+
+std::uint64_t JsonMealRepository::dayVersion(std::chrono::sys_days day) const {
+  return this->versions_.day(day);
+}
+
 }  // namespace cc::storage
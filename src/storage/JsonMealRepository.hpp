@@ -2,7 +2,9 @@
 #include "models/meal_log.hpp"
 #include "nlohmann/json.hpp"
 #include "storage/MealRepository.hpp"
+#include "storage/VersionCounters.hpp"
 #include "utils/date_time_utils.hpp"
+#include <fstream>
 #include <mutex>
 #include <string>
 #include <magic_enum.hpp>
@@ -15,7 +17,11 @@ class JsonMealRepository : public MealRepository {
     // always run it once the repo starts
     cc::utils::Result<void> sync_meals_id() override;
     cc::utils::Result<void> save(const cc::models::MealLog& meal) override;
+    // one atomic file replacement for the whole batch
+    cc::utils::Result<void> saveMany(std::span<const cc::models::MealLog> meals) override;
     cc::utils::Result<cc::models::MealLog> getById(int id) override;
+    cc::utils::Result<std::vector<cc::models::MealLog>>
+    getMany(std::span<const int> ids) override;
     cc::utils::Result<std::vector<cc::models::MealLog>> getByName(cc::models::MEALNAME name) override;
 
     cc::utils::Result<std::vector<cc::models::MealLog>> getByDate(std::chrono::system_clock::time_point tsUtc) override;
@@ -25,10 +31,21 @@ class JsonMealRepository : public MealRepository {
 
     // update or insert if doesn't exist
     cc::utils::Result<void> upsert(const cc::models::MealLog& meal) override;
+    cc::utils::Result<void> upsertMany(std::span<const cc::models::MealLog> meals) override;
 
     // clear all records
     cc::utils::Result<void> clear() override;
 
+    // stream the file: only the current meal and one batch are in memory,
+    // and the lock is only held to open it
+    cc::utils::Result<void> scan(std::size_t batchSize, const MealBatchSink& sink) override;
+    cc::utils::Result<void> scanRange(std::chrono::sys_days from, std::chrono::sys_days to,
+                                      std::size_t batchSize,
+                                      const MealBatchSink& sink) override;
+
+    std::uint64_t version() const override;
+    std::uint64_t dayVersion(std::chrono::sys_days day) const override;
+
     void setFlushOnWrite(bool enable);
 
     // remove copy and assign because mutex is not copyable
@@ -40,8 +57,14 @@ class JsonMealRepository : public MealRepository {
     JsonMealRepository& operator=(JsonMealRepository&&) noexcept = default;
 
   private:
+    // replaces the file atomically, false if it could not be written
+    bool writeFile(const nlohmann::json& content);
+    // stream of the current file, unaffected by later writes
+    std::ifstream openSnapshot() const;
+
     std::string filePath_;
     mutable std::mutex mtx_;
+    VersionCounters versions_;
 };
 
 } // namespace cc::storage
@@ -1,10 +1,15 @@
 #pragma once
 #include "models/meal_log.hpp"
 #include "utils/Result.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,12 +17,20 @@ namespace cc::storage {
 
 class MealRepository {
   public:
+    // gets the next meals of a scan, returns false to stop it
+    using MealBatchSink = std::function<bool(std::span<cc::models::MealLog> meals)>;
+
     virtual ~MealRepository() = default;
 
 
     virtual cc::utils::Result<void> sync_meals_id() = 0;
     virtual cc::utils::Result<void> save(const cc::models::MealLog& meal) = 0;
+    // appends every meal with a single read and write of the storage
+    virtual cc::utils::Result<void> saveMany(std::span<const cc::models::MealLog> meals) = 0;
     virtual cc::utils::Result<cc::models::MealLog> getById(int id) = 0;
+    // all meals whose id is in ids, read in a single pass (missing ids are skipped)
+    virtual cc::utils::Result<std::vector<cc::models::MealLog>>
+    getMany(std::span<const int> ids) = 0;
     virtual cc::utils::Result<std::vector<cc::models::MealLog>> getByName(cc::models::MEALNAME name) = 0;
     virtual cc::utils::Result<std::vector<cc::models::MealLog>> getByDate(std::chrono::system_clock::time_point tsUtc) = 0;
     virtual cc::utils::Result<std::vector<cc::models::MealLog>> list(int offset = 0,
@@ -26,8 +39,24 @@ class MealRepository {
 
     // update or insert if doesn't exist
     virtual cc::utils::Result<void> upsert(const cc::models::MealLog& meal) = 0;
+    // upsert of every meal with a single read and write of the storage
+    virtual cc::utils::Result<void> upsertMany(std::span<const cc::models::MealLog> meals) = 0;
     // clear all records
     virtual cc::utils::Result<void> clear() = 0;
+
+    // every meal in storage order, passed to sink in batches of at most
+    // batchSize; reads a snapshot, so the sink may use the repository
+    virtual cc::utils::Result<void> scan(std::size_t batchSize, const MealBatchSink& sink) = 0;
+    // scan() of the meals of the UTC days from..to
+    virtual cc::utils::Result<void> scanRange(std::chrono::sys_days from,
+                                              std::chrono::sys_days to,
+                                              std::size_t batchSize,
+                                              const MealBatchSink& sink) = 0;
+
+    // grow with every successful write, kept in memory (no storage access):
+    // version() for any meal, dayVersion() for meals of that UTC day
+    virtual std::uint64_t version() const = 0;
+    virtual std::uint64_t dayVersion(std::chrono::sys_days day) const = 0;
 };
 
 } // namespace cc::storage
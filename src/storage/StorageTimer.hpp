@@ -0,0 +1,29 @@
+#pragma once
+#include "utils/Metrics.hpp"
+#include "utils/RequestTiming.hpp"
+#include <string_view>
+
+namespace cc::storage {
+
+// Times one repository call: as the storage phase of the current request
+// and in cc_storage_operation_duration_seconds{repository, operation}.
+class StorageTimer {
+  public:
+    StorageTimer(std::string_view repository, std::string_view operation)
+        : phase_{cc::utils::TimingPhase::Storage},
+          timer_{durations().labels({repository, operation})} {}
+
+  private:
+    static cc::utils::MetricFamily<cc::utils::Histogram>& durations() {
+        static auto& family = cc::utils::MetricsRegistry::global().histogram(
+            "cc_storage_operation_duration_seconds",
+            "Time of the repository calls, including waiting for the file lock",
+            {"repository", "operation"});
+        return family;
+    }
+
+    cc::utils::PhaseTimer phase_;
+    cc::utils::HistogramTimer timer_;
+};
+
+} // namespace cc::storage
@@ -0,0 +1,42 @@
+#include "storage/VersionCounters.hpp"
+
+namespace cc::storage {
+
+VersionCounters::VersionCounters() {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  this->last_ = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+  this->collection_ = this->last_;
+  this->all_days_ = this->last_;
+}
+
+std::uint64_t VersionCounters::collection() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return this->collection_;
+}
+
+std::uint64_t VersionCounters::day(Day d) const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  auto it = this->days_.find(d.time_since_epoch().count());
+  return it == this->days_.end() ? this->all_days_ : it->second;
+}
+
+void VersionCounters::bump() {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->collection_ = ++this->last_;
+}
+
+void VersionCounters::bumpDay(Day d) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->collection_ = ++this->last_;
+  this->days_[d.time_since_epoch().count()] = this->last_;
+}
+
+void VersionCounters::bumpAll() {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->collection_ = ++this->last_;
+  this->all_days_ = this->last_;
+  this->days_.clear();
+}
+
+}  // namespace cc::storage
@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace cc::storage {
+
+// Change counters of a repository, bumped by every successful write.
+// Every version is drawn from one sequence seeded with the start time, so
+// versions only grow and one handed out by an earlier process never comes
+// back (clients use them as ETags).
+class VersionCounters {
+  public:
+    using Day = std::chrono::sys_days;
+
+    VersionCounters();
+
+    // last write of any record
+    std::uint64_t collection() const;
+    // last write of a record of that day, or last bumpAll()
+    std::uint64_t day(Day d) const;
+
+    // a write that is not tied to a day
+    void bump();
+    // a write of a record of that day
+    void bumpDay(Day d);
+    // every record may have changed (clear)
+    void bumpAll();
+
+  private:
+    mutable std::mutex mtx_;
+    std::uint64_t last_;
+    std::uint64_t collection_;
+    // version of the days without an entry of their own
+    std::uint64_t all_days_;
+    std::unordered_map<std::int64_t, std::uint64_t> days_;
+};
+
+} // namespace cc::storage
@@ -0,0 +1,141 @@
+#pragma once
+#include "utils/EvictionPolicy.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace cc::utils {
+
+// Thread safe key/value cache bounded by an approximate memory budget.
+// Which entry is evicted is decided by a pluggable EvictionPolicy.
+template <typename Key, typename Value> class BoundedCache {
+  public:
+    struct Stats {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t evictions{0};
+        std::uint64_t invalidations{0};
+        std::size_t entries{0};
+        std::size_t bytes{0};
+        std::size_t budgetBytes{0};
+        std::string policy;
+    };
+
+    explicit BoundedCache(std::size_t budgetBytes, CachePolicy policy = CachePolicy::LRU)
+        : budget_{budgetBytes}, policy_{makeEvictionPolicy<Key>(policy, budgetBytes)} {}
+
+    BoundedCache(const BoundedCache&) = delete;
+    BoundedCache& operator=(const BoundedCache&) = delete;
+
+    std::optional<Value> get(const Key& key) {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        auto it = this->entries_.find(key);
+        if (it == this->entries_.end()) {
+            this->stats_.misses++;
+            return std::nullopt;
+        }
+        this->stats_.hits++;
+        this->policy_->recordHit(key);
+        return it->second.value;
+    }
+
+    // bumped by every invalidation, read it before loading a value and pass
+    // it to put() so a value loaded before a concurrent write is dropped
+    std::uint64_t epoch() const {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        return this->epoch_;
+    }
+
+    void put(const Key& key, Value value, std::size_t bytes,
+             std::optional<std::uint64_t> loadedAtEpoch = std::nullopt) {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        if (loadedAtEpoch && *loadedAtEpoch != this->epoch_) return;
+        if (bytes > this->budget_) return;
+        this->eraseLocked(key);
+        // room is made before the entry goes in, so the new entry is never
+        // its own victim (ARC runs REPLACE before inserting into T1)
+        this->policy_->prepareInsert(key, bytes);
+        while (this->bytes_ + bytes > this->budget_ && !this->entries_.empty()) {
+            Key victim = this->policy_->evict();
+            auto it = this->entries_.find(victim);
+            if (it != this->entries_.end()) {
+                this->bytes_ -= it->second.bytes;
+                this->entries_.erase(it);
+                this->stats_.evictions++;
+            }
+        }
+        this->entries_.emplace(key, Entry{std::move(value), bytes});
+        this->bytes_ += bytes;
+        this->policy_->recordInsert(key, bytes);
+    }
+
+    void erase(const Key& key) {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        this->epoch_++;
+        if (this->eraseLocked(key)) {
+            this->stats_.invalidations++;
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        this->epoch_++;
+        this->stats_.invalidations += this->entries_.size();
+        this->entries_.clear();
+        this->policy_->clear();
+        this->bytes_ = 0;
+    }
+
+    // drops every entry and switches budget and policy
+    void configure(std::size_t budgetBytes, CachePolicy policy) {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        this->epoch_++;
+        this->entries_.clear();
+        this->bytes_ = 0;
+        this->budget_ = budgetBytes;
+        this->policy_ = makeEvictionPolicy<Key>(policy, budgetBytes);
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        Stats s = this->stats_;
+        s.entries = this->entries_.size();
+        s.bytes = this->bytes_;
+        s.budgetBytes = this->budget_;
+        s.policy = std::string(this->policy_->name());
+        return s;
+    }
+
+  private:
+    struct Entry {
+        Value value;
+        std::size_t bytes;
+    };
+
+    bool eraseLocked(const Key& key) {
+        auto it = this->entries_.find(key);
+        if (it == this->entries_.end()) {
+            // not resident: leave ghost history to the policy
+            return false;
+        }
+        this->bytes_ -= it->second.bytes;
+        this->entries_.erase(it);
+        this->policy_->recordErase(key);
+        return true;
+    }
+
+    mutable std::mutex mtx_;
+    std::size_t budget_;
+    std::size_t bytes_{0};
+    std::uint64_t epoch_{0};
+    std::unique_ptr<EvictionPolicy<Key>> policy_;
+    std::unordered_map<Key, Entry> entries_;
+    Stats stats_;
+};
+
+} // namespace cc::utils
@@ -0,0 +1,155 @@
+#include "utils/Compression.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace cc::utils {
+
+namespace {
+// zlib window bits: +16 asks for a gzip header and trailer
+constexpr int kZlibWindow = 15;
+constexpr int kGzipWindow = 15 + 16;
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+  return s;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+// q-value of one "coding;q=0.5" entry, 1 when absent, -1 when malformed
+double qValue(std::string_view params) {
+  while (!params.empty()) {
+    const std::size_t semi = params.find(';');
+    std::string_view param = trim(params.substr(0, semi));
+    params = semi == std::string_view::npos ? std::string_view{}
+                                            : params.substr(semi + 1);
+    if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') &&
+        param[1] == '=') {
+      double q = -1;
+      param.remove_prefix(2);
+      auto res = std::from_chars(param.data(), param.data() + param.size(), q);
+      if (res.ec != std::errc{}) return -1;
+      return std::clamp(q, 0.0, 1.0);
+    }
+  }
+  return 1;
+}
+}  // namespace
+
+std::string_view encodingName(ContentEncoding encoding) {
+  switch (encoding) {
+    case ContentEncoding::Gzip:
+      return "gzip";
+    case ContentEncoding::Deflate:
+      return "deflate";
+    default:
+      return "identity";
+  }
+}
+
+ContentEncoding negotiateEncoding(std::string_view acceptEncoding) {
+  // -1: not listed
+  double gzip = -1;
+  double deflate = -1;
+  double wildcard = -1;
+  while (!acceptEncoding.empty()) {
+    const std::size_t comma = acceptEncoding.find(',');
+    std::string_view entry = acceptEncoding.substr(0, comma);
+    acceptEncoding = comma == std::string_view::npos
+                         ? std::string_view{}
+                         : acceptEncoding.substr(comma + 1);
+    const std::size_t semi = entry.find(';');
+    const std::string_view coding = trim(entry.substr(0, semi));
+    const double q = semi == std::string_view::npos
+                         ? 1
+                         : qValue(entry.substr(semi + 1));
+    if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip")) {
+      gzip = std::max(gzip, q);
+    } else if (equalsIgnoreCase(coding, "deflate")) {
+      deflate = std::max(deflate, q);
+    } else if (coding == "*") {
+      wildcard = std::max(wildcard, q);
+    }
+  }
+  // "*" covers the codings not listed explicitly
+  if (gzip < 0) gzip = wildcard;
+  if (deflate < 0) deflate = wildcard;
+  if (gzip <= 0 && deflate <= 0) return ContentEncoding::Identity;
+  return gzip >= deflate ? ContentEncoding::Gzip : ContentEncoding::Deflate;
+}
+
+Result<std::string> compress(std::string_view body, ContentEncoding encoding,
+                             int level) {
+  if (encoding == ContentEncoding::Identity) {
+    return Result<std::string>::ok(std::string(body));
+  }
+  z_stream stream{};
+  const int window =
+      encoding == ContentEncoding::Gzip ? kGzipWindow : kZlibWindow;
+  if (deflateInit2(&stream, std::clamp(level, 1, 9), Z_DEFLATED, window, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return Result<std::string>::fail(ErrorCode::Unknown,
+                                     "can't initialize compression");
+  }
+  std::string out;
+  // one call, the bound is large enough for incompressible input
+  out.resize(deflateBound(&stream, static_cast<uLong>(body.size())));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  stream.avail_in = static_cast<uInt>(body.size());
+  stream.next_out = reinterpret_cast<Bytef*>(out.data());
+  stream.avail_out = static_cast<uInt>(out.size());
+  const int rc = deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (rc != Z_STREAM_END) {
+    return Result<std::string>::fail(ErrorCode::Unknown, "compression failed");
+  }
+  return Result<std::string>::ok(std::move(out));
+}
+
+Result<std::string> decompress(std::string_view body,
+                               ContentEncoding encoding) {
+  if (encoding == ContentEncoding::Identity) {
+    return Result<std::string>::ok(std::string(body));
+  }
+  z_stream stream{};
+  const int window =
+      encoding == ContentEncoding::Gzip ? kGzipWindow : kZlibWindow;
+  if (inflateInit2(&stream, window) != Z_OK) {
+    return Result<std::string>::fail(ErrorCode::Unknown,
+                                     "can't initialize decompression");
+  }
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  stream.avail_in = static_cast<uInt>(body.size());
+  std::string out;
+  char buf[16384];
+  int rc = Z_OK;
+  while (rc == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buf);
+    stream.avail_out = sizeof(buf);
+    rc = inflate(&stream, Z_NO_FLUSH);
+    out.append(buf, sizeof(buf) - stream.avail_out);
+    if (rc == Z_BUF_ERROR && stream.avail_in == 0) break;
+  }
+  inflateEnd(&stream);
+  if (rc != Z_STREAM_END) {
+    return Result<std::string>::fail(ErrorCode::ParseError,
+                                     "invalid compressed body");
+  }
+  return Result<std::string>::ok(std::move(out));
+}
+
+}  // namespace cc::utils
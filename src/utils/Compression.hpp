@@ -0,0 +1,25 @@
+#pragma once
+#include "utils/Result.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace cc::utils {
+
+// HTTP content codings the server can produce (zlib based).
+enum class ContentEncoding : std::uint8_t { Identity, Gzip, Deflate };
+
+// value for the Content-Encoding header, "identity" for Identity
+std::string_view encodingName(ContentEncoding encoding);
+
+// best coding allowed by an Accept-Encoding header: highest q-value wins,
+// gzip before deflate on a tie, Identity if neither is acceptable
+ContentEncoding negotiateEncoding(std::string_view acceptEncoding);
+
+// level 1 (fastest) .. 9 (smallest), out of range values are clamped;
+// Deflate is the zlib wrapped stream HTTP calls "deflate"
+Result<std::string> compress(std::string_view body, ContentEncoding encoding, int level);
+// inverse of compress, for tests and clients
+Result<std::string> decompress(std::string_view body, ContentEncoding encoding);
+
+} // namespace cc::utils
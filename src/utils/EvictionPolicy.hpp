@@ -0,0 +1,238 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace cc::utils {
+
+enum class CachePolicy : std::uint8_t { LRU, ARC };
+
+// Decides which resident entry leaves the cache when the byte budget is
+// exceeded. Sizes are in bytes so policies can weigh large entries.
+template <typename Key> class EvictionPolicy {
+  public:
+    virtual ~EvictionPolicy() = default;
+
+    // a new entry is about to become resident, called before the evictions
+    // that make room for it
+    virtual void prepareInsert(const Key& /*key*/, std::size_t /*bytes*/) {}
+    // a new entry became resident
+    virtual void recordInsert(const Key& key, std::size_t bytes) = 0;
+    // a resident entry was read
+    virtual void recordHit(const Key& key) = 0;
+    // a resident entry was invalidated (not an eviction)
+    virtual void recordErase(const Key& key) = 0;
+    // picks and forgets a victim, precondition: at least one resident entry
+    virtual Key evict() = 0;
+    virtual void clear() = 0;
+    virtual std::string_view name() const = 0;
+};
+
+// Least recently used first.
+template <typename Key> class LruPolicy : public EvictionPolicy<Key> {
+  public:
+    void recordInsert(const Key& key, std::size_t) override {
+        this->order_.push_front(key);
+        this->pos_[key] = this->order_.begin();
+    }
+    void recordHit(const Key& key) override {
+        auto it = this->pos_.find(key);
+        if (it != this->pos_.end()) {
+            this->order_.splice(this->order_.begin(), this->order_, it->second);
+        }
+    }
+    void recordErase(const Key& key) override {
+        auto it = this->pos_.find(key);
+        if (it != this->pos_.end()) {
+            this->order_.erase(it->second);
+            this->pos_.erase(it);
+        }
+    }
+    Key evict() override {
+        Key victim = this->order_.back();
+        this->order_.pop_back();
+        this->pos_.erase(victim);
+        return victim;
+    }
+    void clear() override {
+        this->order_.clear();
+        this->pos_.clear();
+    }
+    std::string_view name() const override { return "LRU"; }
+
+  private:
+    std::list<Key> order_;
+    std::unordered_map<Key, typename std::list<Key>::iterator> pos_;
+};
+
+// Adaptive Replacement Cache (Megiddo & Modha), weighted by entry size.
+// T1 holds entries seen once, T2 entries seen at least twice; B1/B2 remember
+// recently evicted keys so a miss on them shifts the target size of T1.
+template <typename Key> class ArcPolicy : public EvictionPolicy<Key> {
+  public:
+    explicit ArcPolicy(std::size_t capacityBytes) : capacity_{std::max<std::size_t>(1, capacityBytes)} {}
+
+    // adapts the target to a ghost hit before REPLACE picks the victims,
+    // as in the paper; the key enters T1 or T2 in recordInsert
+    void prepareInsert(const Key& key, std::size_t bytes) override {
+        this->promote_ = false;
+        this->from_b2_ = false;
+        if (this->b1_.contains(key)) {
+            // recency was evicted too early, grow T1
+            const double ratio = this->b1_.count() >= this->b2_.count()
+                                     ? 1.0
+                                     : double(this->b2_.count()) / double(this->b1_.count());
+            this->target_ = std::min<double>(double(this->capacity_), this->target_ + ratio * double(bytes));
+            this->b1_.remove(key);
+            this->promote_ = true;
+        } else if (this->b2_.contains(key)) {
+            // frequency was evicted too early, shrink T1
+            const double ratio = this->b2_.count() >= this->b1_.count()
+                                     ? 1.0
+                                     : double(this->b1_.count()) / double(this->b2_.count());
+            this->target_ = std::max<double>(0.0, this->target_ - ratio * double(bytes));
+            this->b2_.remove(key);
+            this->promote_ = true;
+            this->from_b2_ = true;
+        }
+    }
+
+    void recordInsert(const Key& key, std::size_t bytes) override {
+        // without a prepareInsert the ghost hit is handled here
+        if (this->b1_.contains(key) || this->b2_.contains(key)) {
+            this->prepareInsert(key, bytes);
+        }
+        if (this->promote_) {
+            this->t2_.pushFront(key, bytes);
+        } else {
+            this->t1_.pushFront(key, bytes);
+        }
+        this->promote_ = false;
+        this->from_b2_ = false;
+        this->trimGhosts();
+    }
+
+    void recordHit(const Key& key) override {
+        if (this->t1_.contains(key)) {
+            std::size_t bytes = this->t1_.remove(key);
+            this->t2_.pushFront(key, bytes);
+        } else if (this->t2_.contains(key)) {
+            this->t2_.touch(key);
+        }
+    }
+
+    void recordErase(const Key& key) override {
+        this->t1_.remove(key);
+        this->t2_.remove(key);
+        this->b1_.remove(key);
+        this->b2_.remove(key);
+    }
+
+    Key evict() override {
+        // REPLACE: T1 gives way above its target, or at it for a B2 hit
+        const double t1_bytes = double(this->t1_.bytes());
+        const bool from_t1 = !this->t1_.empty() &&
+                             (t1_bytes > this->target_ || (this->from_b2_ && t1_bytes == this->target_) ||
+                              this->t2_.empty());
+        Key victim;
+        if (from_t1) {
+            auto [key, bytes] = this->t1_.popBack();
+            this->b1_.pushFront(key, bytes);
+            victim = key;
+        } else {
+            auto [key, bytes] = this->t2_.popBack();
+            this->b2_.pushFront(key, bytes);
+            victim = key;
+        }
+        this->trimGhosts();
+        return victim;
+    }
+
+    void clear() override {
+        this->t1_.clear();
+        this->t2_.clear();
+        this->b1_.clear();
+        this->b2_.clear();
+        this->target_ = 0.0;
+        this->promote_ = false;
+        this->from_b2_ = false;
+    }
+    std::string_view name() const override { return "ARC"; }
+
+  private:
+    // recency ordered list of keys with their byte sizes
+    class Segment {
+      public:
+        bool contains(const Key& key) const { return this->pos_.contains(key); }
+        bool empty() const { return this->order_.empty(); }
+        std::size_t count() const { return this->order_.size(); }
+        std::size_t bytes() const { return this->bytes_; }
+        void pushFront(const Key& key, std::size_t bytes) {
+            this->order_.emplace_front(key, bytes);
+            this->pos_[key] = this->order_.begin();
+            this->bytes_ += bytes;
+        }
+        void touch(const Key& key) {
+            this->order_.splice(this->order_.begin(), this->order_, this->pos_.at(key));
+        }
+        std::size_t remove(const Key& key) {
+            auto it = this->pos_.find(key);
+            if (it == this->pos_.end()) return 0;
+            std::size_t bytes = it->second->second;
+            this->bytes_ -= bytes;
+            this->order_.erase(it->second);
+            this->pos_.erase(it);
+            return bytes;
+        }
+        std::pair<Key, std::size_t> popBack() {
+            auto back = this->order_.back();
+            this->remove(back.first);
+            return back;
+        }
+        void clear() {
+            this->order_.clear();
+            this->pos_.clear();
+            this->bytes_ = 0;
+        }
+
+      private:
+        using Entry = std::pair<Key, std::size_t>;
+        std::list<Entry> order_;
+        std::unordered_map<Key, typename std::list<Entry>::iterator> pos_;
+        std::size_t bytes_{0};
+    };
+
+    // ghosts only keep keys, bound them like the original algorithm:
+    // |T1|+|B1| <= c and |T1|+|T2|+|B1|+|B2| <= 2c
+    void trimGhosts() {
+        while (!this->b1_.empty() && this->t1_.bytes() + this->b1_.bytes() > this->capacity_) {
+            this->b1_.popBack();
+        }
+        while (!this->b2_.empty() && this->t1_.bytes() + this->t2_.bytes() + this->b1_.bytes() +
+                                             this->b2_.bytes() >
+                                         2 * this->capacity_) {
+            this->b2_.popBack();
+        }
+    }
+
+    std::size_t capacity_;
+    double target_{0.0}; // target size of T1 in bytes ("p" in the paper)
+    // the key being inserted was a ghost: it goes to T2 (from B2: from_b2_)
+    bool promote_{false};
+    bool from_b2_{false};
+    Segment t1_, t2_, b1_, b2_;
+};
+
+template <typename Key>
+std::unique_ptr<EvictionPolicy<Key>> makeEvictionPolicy(CachePolicy policy, std::size_t capacityBytes) {
+    if (policy == CachePolicy::ARC) {
+        return std::make_unique<ArcPolicy<Key>>(capacityBytes);
+    }
+    return std::make_unique<LruPolicy<Key>>();
+}
+
+} // namespace cc::utils
@@ -0,0 +1,123 @@
+#include "utils/ExportFormat.hpp"
+
+#include <magic_enum.hpp>
+
+#include "models/nutrient.hpp"
+#include "utils/Json_utils.hpp"
+#include "utils/date_time_utils.hpp"
+
+namespace cc::utils {
+
+namespace {
+void appendNutrientNames(std::string& out) {
+  for (const auto& info : cc::models::NUTRIENTS) {
+    out += ',';
+    out += magic_enum::enum_name(info.type);
+  }
+}
+}  // namespace
+
+std::optional<ExportFormat> parseExportFormat(std::string_view name) {
+  if (name.empty() || name == "ndjson") return ExportFormat::Ndjson;
+  if (name == "csv") return ExportFormat::Csv;
+  return std::nullopt;
+}
+
+std::string_view contentType(ExportFormat format) {
+  return format == ExportFormat::Csv ? "text/csv; charset=utf-8"
+                                     : "application/x-ndjson";
+}
+
+void appendCsvField(std::string& out, std::string_view field) {
+  if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+    out += field;
+    return;
+  }
+  out += '"';
+  for (char c : field) {
+    if (c == '"') out += '"';
+    out += c;
+  }
+  out += '"';
+}
+
+void appendFoodHeader(std::string& out, ExportFormat format) {
+  if (format != ExportFormat::Csv) return;
+  out += "id,name,brand,barcode,caloriesPer100g,source";
+  appendNutrientNames(out);
+  out += '\n';
+}
+
+void appendFood(std::string& out, JsonWriter& w, const cc::models::Food& food,
+                ExportFormat format) {
+  if (format == ExportFormat::Ndjson) {
+    w.clear();
+    writeJson(w, food);
+    out += w.str();
+    out += '\n';
+    return;
+  }
+  appendCsvField(out, food.id());
+  out += ',';
+  appendCsvField(out, food.name());
+  out += ',';
+  appendCsvField(out, food.brand().value_or(""));
+  out += ',';
+  appendCsvField(out, food.barcode().value_or(""));
+  out += ',';
+  appendDouble(out, food.caloriesPer100g());
+  out += ',';
+  out += magic_enum::enum_name(food.source());
+  for (const auto& info : cc::models::NUTRIENTS) {
+    out += ',';
+    if (food.hasNutrient(info.type)) appendDouble(out, food.nutrient(info.type));
+  }
+  out += '\n';
+}
+
+void appendMealHeader(std::string& out, ExportFormat format, bool nutrition) {
+  if (format != ExportFormat::Csv) return;
+  out += "id,name,tsUtc,foodItems";
+  if (nutrition) {
+    out += ",calories";
+    appendNutrientNames(out);
+  }
+  out += '\n';
+}
+
+void appendMeal(std::string& out, JsonWriter& w, const cc::models::MealLog& meal,
+                ExportFormat format, bool nutrition) {
+  if (format == ExportFormat::Ndjson) {
+    w.clear();
+    writeJson(w, meal);
+    out += w.str();
+    out += '\n';
+    return;
+  }
+  out += std::to_string(meal.id());
+  out += ',';
+  out += magic_enum::enum_name(meal.getName());
+  out += ',';
+  out += toIso8601(meal.gettime());
+  out += ',';
+  std::string items;
+  for (const auto& [food_id, grams] : meal.food_items()) {
+    if (!items.empty()) items += ';';
+    items += food_id;
+    items += ':';
+    appendDouble(items, grams);
+  }
+  appendCsvField(out, items);
+  if (nutrition) {
+    const auto& totals = meal.nutrition();
+    out += ',';
+    if (totals) appendDouble(out, totals->calories);
+    for (const auto& info : cc::models::NUTRIENTS) {
+      out += ',';
+      if (totals) appendDouble(out, (*totals)[info.type]);
+    }
+  }
+  out += '\n';
+}
+
+}  // namespace cc::utils
@@ -0,0 +1,35 @@
+#pragma once
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "utils/JsonWriter.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cc::utils {
+
+// Row formats of the /export routes, appended to a growing body.
+enum class ExportFormat : std::uint8_t { Ndjson, Csv };
+
+// "ndjson" (also the default for an empty value) or "csv"
+std::optional<ExportFormat> parseExportFormat(std::string_view name);
+std::string_view contentType(ExportFormat format);
+
+// RFC 4180 field: quoted when it holds a comma, quote or line break
+void appendCsvField(std::string& out, std::string_view field);
+
+// header line, empty for NDJSON
+void appendFoodHeader(std::string& out, ExportFormat format);
+// one line per food, CSV has a column per nutrient (per 100g)
+void appendFood(std::string& out, JsonWriter& w, const cc::models::Food& food,
+                ExportFormat format);
+
+// nutrition: CSV columns for calories and every nutrient, left empty for
+// meals without totals
+void appendMealHeader(std::string& out, ExportFormat format, bool nutrition);
+// CSV foodItems are "foodId:grams" joined by ';'
+void appendMeal(std::string& out, JsonWriter& w, const cc::models::MealLog& meal,
+                ExportFormat format, bool nutrition);
+
+} // namespace cc::utils
@@ -0,0 +1,45 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace cc::utils {
+
+// Binary indexed tree over a fixed number of slots: point add and prefix or
+// range sums in O(log n). T needs a default value of zero, += and -=.
+template <typename T> class FenwickTree {
+  public:
+    explicit FenwickTree(std::size_t size = 0) : tree_(size + 1) {}
+
+    std::size_t size() const { return this->tree_.size() - 1; }
+
+    void add(std::size_t index, const T& delta) {
+        for (std::size_t i = index + 1; i < this->tree_.size(); i += lowbit(i)) {
+            this->tree_[i] += delta;
+        }
+    }
+
+    // sum of the first `count` slots
+    T prefix(std::size_t count) const {
+        T sum{};
+        for (std::size_t i = std::min(count, this->size()); i > 0; i -= lowbit(i)) {
+            sum += this->tree_[i];
+        }
+        return sum;
+    }
+
+    // sum of the slots first..last, both included
+    T range(std::size_t first, std::size_t last) const {
+        if (first > last) return T{};
+        T sum = this->prefix(last + 1);
+        sum -= this->prefix(first);
+        return sum;
+    }
+
+  private:
+    static std::size_t lowbit(std::size_t i) { return i & (~i + 1); }
+
+    std::vector<T> tree_;
+};
+
+} // namespace cc::utils
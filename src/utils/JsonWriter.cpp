@@ -0,0 +1,162 @@
+#include "utils/JsonWriter.hpp"
+
+#include <cmath>
+#include <utility>
+
+namespace cc::utils {
+
+namespace {
+constexpr char HEX[] = "0123456789abcdef";
+
+bool needsEscape(unsigned char c) { return c < 0x20 || c == '"' || c == '\\'; }
+}  // namespace
+
+void appendDouble(std::string& out, double d) {
+  if (!std::isfinite(d)) {
+    out += "null";
+    return;
+  }
+  char buf[32];
+  auto res = std::to_chars(buf, buf + sizeof(buf), d);
+  std::string_view text(buf, res.ptr - buf);
+  out += text;
+  if (text.find_first_of(".e") == std::string_view::npos) {
+    out += ".0";
+  }
+}
+
+void appendEscaped(std::string& out, std::string_view s) {
+  out += '"';
+  std::size_t run = 0;
+  for (std::size_t i = 0; i < s.size(); i++) {
+    const auto c = static_cast<unsigned char>(s[i]);
+    if (!needsEscape(c)) continue;
+    // copy the clean run before the character in one go
+    out.append(s.data() + run, i - run);
+    run = i + 1;
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      default:
+        out += "\\u00";
+        out += HEX[c >> 4];
+        out += HEX[c & 0xF];
+    }
+  }
+  out.append(s.data() + run, s.size() - run);
+  out += '"';
+}
+
+JsonWriter::JsonWriter(std::size_t reserveBytes) {
+  this->out_.reserve(reserveBytes);
+}
+
+void JsonWriter::separator() {
+  if (this->after_key_) {
+    this->after_key_ = false;
+    return;
+  }
+  if (!this->first_.empty()) {
+    if (!this->first_.back()) this->out_ += ',';
+    this->first_.back() = false;
+  }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+  this->separator();
+  this->out_ += '{';
+  this->first_.push_back(true);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+  this->out_ += '}';
+  this->first_.pop_back();
+  return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+  this->separator();
+  this->out_ += '[';
+  this->first_.push_back(true);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+  this->out_ += ']';
+  this->first_.pop_back();
+  return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view k) {
+  this->separator();
+  appendEscaped(this->out_, k);
+  this->out_ += ':';
+  this->after_key_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view s) {
+  this->separator();
+  appendEscaped(this->out_, s);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+  this->separator();
+  this->out_ += b ? "true" : "false";
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(double d) {
+  this->separator();
+  appendDouble(this->out_, d);
+  return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+  this->separator();
+  this->out_ += "null";
+  return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+  this->separator();
+  this->out_ += json;
+  return *this;
+}
+
+const std::string& JsonWriter::str() const { return this->out_; }
+
+std::string JsonWriter::take() {
+  this->first_.clear();
+  this->after_key_ = false;
+  return std::exchange(this->out_, std::string{});
+}
+
+void JsonWriter::clear() {
+  this->out_.clear();
+  this->first_.clear();
+  this->after_key_ = false;
+}
+
+}  // namespace cc::utils
@@ -0,0 +1,76 @@
+#pragma once
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cc::utils {
+
+// Appends JSON text to a string as values are written, no document is
+// built. Commas are inserted automatically; the caller is responsible for
+// balancing begin/end and putting a key before every object member.
+class JsonWriter {
+  public:
+    explicit JsonWriter(std::size_t reserveBytes = 256);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(std::string_view k);
+
+    JsonWriter& value(std::string_view s);
+    JsonWriter& value(const std::string& s) { return this->value(std::string_view{s}); }
+    JsonWriter& value(const char* s) { return this->value(std::string_view{s}); }
+    JsonWriter& value(bool b);
+    JsonWriter& value(double d);
+    JsonWriter& null();
+    // an already serialized JSON value, written as is
+    JsonWriter& raw(std::string_view json);
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    JsonWriter& value(T v) {
+        this->separator();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        this->out_.append(buf, res.ptr);
+        return *this;
+    }
+
+    template <typename T> JsonWriter& value(const std::optional<T>& v) {
+        return v ? this->value(*v) : this->null();
+    }
+
+    // key(k).value(v)
+    template <typename T> JsonWriter& field(std::string_view k, const T& v) {
+        this->key(k);
+        return this->value(v);
+    }
+
+    const std::string& str() const;
+    // moves the text out, the writer is empty afterwards
+    std::string take();
+    // empties the writer but keeps its buffer, to write the next document
+    void clear();
+
+  private:
+    void separator();
+
+    std::string out_;
+    // one entry per open container, true until its first element is written
+    std::vector<bool> first_;
+    bool after_key_{false};
+};
+
+// shortest text that parses back to d, like nlohmann's dump: integral values
+// keep a ".0", NaN and infinities are written as null
+void appendDouble(std::string& out, double d);
+// appends s as a quoted JSON string
+void appendEscaped(std::string& out, std::string_view s);
+
+} // namespace cc::utils
@@ -1,5 +1,11 @@
 #include "utils/Json_utils.hpp"
 
+#include "utils/date_time_utils.hpp"
+
+#include <magic_enum.hpp>
+#include <optional>
+#include <utility>
+
 namespace cc::utils {
 crow::json::wvalue to_crow_json(const nlohmann::json& j) {
     crow::json::wvalue result;
@@ -28,4 +34,153 @@ crow::json::wvalue to_crow_json(const nlohmann::json& j) {
 
     return result;
 }
-} // namespace cc::utils
\ No newline at end of file
+
+void writeJson(JsonWriter& w, const cc::models::Food& food) {
+    w.beginObject();
+    w.field("id", food.id());
+    w.field("name", food.name());
+    w.key("nutrient").beginArray();
+    for (std::size_t i = 0; i < cc::models::NUTRIENT_COUNT; i++) {
+        const auto type = static_cast<cc::models::NutrientType>(i);
+        if (!food.hasNutrient(type)) continue;
+        w.beginObject();
+        w.field("type", magic_enum::enum_name(type));
+        w.field("value", food.nutrient(type));
+        w.field("unit", cc::models::canonicalUnit(type));
+        w.endObject();
+    }
+    w.endArray();
+    w.field("caloriesPer100g", food.caloriesPer100g());
+    w.field("barcode", food.barcode());
+    w.field("brand", food.brand());
+    w.field("imageUrl", food.imageUrl());
+    w.field("source", magic_enum::enum_name(food.source()));
+    w.endObject();
+}
+
+void writeJson(JsonWriter& w, const cc::models::MealLog& meal) {
+    w.beginObject();
+    w.field("name", magic_enum::enum_name(meal.getName()));
+    w.field("id", meal.id());
+    w.key("foodItems").beginArray();
+    for (const auto& [food_id, grams] : meal.food_items()) {
+        w.beginArray().value(food_id).value(grams).endArray();
+    }
+    w.endArray();
+    w.field("tsUtc", cc::utils::toIso8601(meal.gettime()));
+    if (const auto& nutrition = meal.nutrition()) {
+        w.field("calories", nutrition->calories);
+        for (const auto& info : cc::models::NUTRIENTS) {
+            w.field(magic_enum::enum_name(info.type), (*nutrition)[info.type]);
+        }
+    }
+    w.endObject();
+}
+
+Result<cc::models::Food> foodFromRecord(const nlohmann::json& record) {
+    using R = Result<cc::models::Food>;
+    if (!record.is_object()) return R::fail(ErrorCode::InvalidInput, "not an object");
+    auto text = [&](const char* key) -> std::optional<std::string> {
+        auto it = record.find(key);
+        if (it == record.end() || !it->is_string()) return std::nullopt;
+        return it->get<std::string>();
+    };
+    const auto id = text("id");
+    if (!id || id->empty()) return R::fail(ErrorCode::InvalidInput, "missing field: id");
+    const auto name = text("name");
+    if (!name) return R::fail(ErrorCode::InvalidInput, "missing field: name");
+    // POST /foods spelling, or the one GET /foods returns
+    auto kcal = record.find("caloriePer100g");
+    if (kcal == record.end()) kcal = record.find("caloriesPer100g");
+    if (kcal == record.end() || !kcal->is_number() || kcal->get<double>() < 0) {
+        return R::fail(ErrorCode::InvalidInput, "missing or negative field: caloriePer100g");
+    }
+
+    cc::models::Food food;
+    food.setId(*id);
+    food.setName(*name);
+    food.setBarcode(text("barcode").value_or(*id));
+    food.setBrand(text("brand").value_or(""));
+    food.setCaloriesPer100g(kcal->get<double>());
+    food.setSource(cc::models::SOURCE::Manual);
+    if (auto image = text("imageUrl")) food.setImageUrl(*image);
+    std::vector<cc::models::Nutrient> nutrients;
+    if (auto list = record.find("nutrient"); list != record.end() && !list->is_null()) {
+        if (!list->is_array()) return R::fail(ErrorCode::InvalidInput, "nutrient is not an array");
+        for (const auto& n : *list) {
+            if (!n.is_object() || !n.contains("type") || !n["type"].is_string() ||
+                !n.contains("value") || !n["value"].is_number()) {
+                return R::fail(ErrorCode::InvalidInput, "nutrient needs a type and a value");
+            }
+            if (n.contains("unit") && !n["unit"].is_string()) {
+                return R::fail(ErrorCode::InvalidInput, "nutrient unit is not a string");
+            }
+            cc::models::Nutrient nutrient;
+            nutrient.setType(magic_enum::enum_cast<cc::models::NutrientType>(
+                                 n["type"].get<std::string>())
+                                 .value_or(cc::models::NutrientType::Unknown));
+            nutrient.setUnit(n.value("unit", std::string("g")));
+            nutrient.setValue(n["value"].get<double>());
+            nutrients.push_back(nutrient);
+        }
+    }
+    food.setNutrients(nutrients);
+    return R::ok(std::move(food));
+}
+
+Result<cc::models::MealLog> mealFromRecord(const nlohmann::json& record) {
+    using R = Result<cc::models::MealLog>;
+    if (!record.is_object()) return R::fail(ErrorCode::InvalidInput, "not an object");
+    auto name = record.find("name");
+    if (name == record.end() || !name->is_string()) {
+        return R::fail(ErrorCode::InvalidInput, "missing field: name");
+    }
+    auto meal_name = magic_enum::enum_cast<cc::models::MEALNAME>(name->get<std::string>());
+    if (!meal_name) return R::fail(ErrorCode::InvalidInput, "invalid meal name");
+
+    TimePoint time = std::chrono::system_clock::now();
+    if (auto ts = record.find("tsUtc"); ts != record.end()) {
+        time = ts->is_string() ? fromIso8601(ts->get<std::string>()) : TimePoint{};
+        if (time == TimePoint{}) {
+            return R::fail(ErrorCode::InvalidInput, "invalid tsUtc (use YYYY-MM-DDTHH:MM:SSZ)");
+        }
+    }
+
+    std::vector<std::pair<std::string, double>> items;
+    if (auto list = record.find("foodItems"); list != record.end()) {
+        if (!list->is_array()) return R::fail(ErrorCode::InvalidInput, "foodItems is not an array");
+        for (const auto& it : *list) {
+            // {"foodId": "007", "grams": 50} or ["007", 50] as meals are stored
+            const bool is_pair = it.is_array() && it.size() == 2;
+            const nlohmann::json* id = is_pair ? &it[0]
+                                       : it.is_object() && it.contains("foodId") ? &it["foodId"]
+                                                                                 : nullptr;
+            const nlohmann::json* grams = is_pair ? &it[1]
+                                          : it.is_object() && it.contains("grams") ? &it["grams"]
+                                                                                   : nullptr;
+            if (!id || !grams || !id->is_string() || !grams->is_number() ||
+                grams->get<double>() <= 0) {
+                return R::fail(ErrorCode::InvalidInput,
+                               "food item needs a foodId and positive grams");
+            }
+            items.emplace_back(id->get<std::string>(), grams->get<double>());
+        }
+    }
+
+    cc::models::MealLog meal(*meal_name);
+    meal.setTime(time);
+    meal.setFoodItems(items);
+    return R::ok(std::move(meal));
+}
+
+crow::response json_response(int code, std::string body) {
+    crow::response res(code, std::move(body));
+    res.set_header("Content-Type", "application/json");
+    return res;
+}
+
+crow::response json_response(int code, const nlohmann::json& j) {
+    // invalid UTF-8 in stored strings is replaced instead of failing the request
+    return json_response(code, j.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+}
+} // namespace cc::utils
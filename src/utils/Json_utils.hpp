@@ -1,6 +1,9 @@
 #pragma once
 #include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "utils/JsonWriter.hpp"
 #include "utils/Result.hpp"
+#include <crow/http_response.h>
 #include <crow/json.h>
 #include <string>
 
@@ -10,4 +13,16 @@ namespace cc::utils {
 // static std::string toJson(const cc::models::Food &food) const;
 // static Result<cc::models::Food> fromJson(const std::string &jsonStr) const;
 crow::json::wvalue to_crow_json(const nlohmann::json& j);
+
+// same fields as the nlohmann to_json of the model, written straight to text
+void writeJson(JsonWriter& w, const cc::models::Food& food);
+void writeJson(JsonWriter& w, const cc::models::MealLog& meal);
+// Food / MealLog from a record in the POST /foods, POST /meals body format,
+// InvalidInput naming the first missing or malformed field
+Result<cc::models::Food> foodFromRecord(const nlohmann::json& record);
+Result<cc::models::MealLog> mealFromRecord(const nlohmann::json& record);
+// response with an already serialized json body
+crow::response json_response(int code, std::string body);
+// serializes j directly, without going through crow::json::wvalue
+crow::response json_response(int code, const nlohmann::json& j);
 } // namespace cc::utils
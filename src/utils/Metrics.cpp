@@ -0,0 +1,286 @@
+#include "utils/Metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace cc::utils {
+
+namespace {
+std::atomic<std::size_t> next_shard{0};
+
+std::string_view typeName(MetricType type) {
+  switch (type) {
+    case MetricType::Counter:
+      return "counter";
+    case MetricType::Gauge:
+      return "gauge";
+    case MetricType::Histogram:
+      return "histogram";
+  }
+  return "untyped";
+}
+
+void appendValue(std::string& out, double v) {
+  if (std::isnan(v)) {
+    out += "NaN";
+  } else if (std::isinf(v)) {
+    out += v > 0 ? "+Inf" : "-Inf";
+  } else {
+    out += std::format("{}", v);
+  }
+}
+
+// label values escape backslash, quote and newline; HELP only the first
+// and the last
+void appendEscaped(std::string& out, std::string_view s, bool quotes) {
+  for (char c : s) {
+    if (c == '\\') {
+      out += "\\\\";
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (c == '"' && quotes) {
+      out += "\\\"";
+    } else {
+      out += c;
+    }
+  }
+}
+
+// family whose samples are read from a function at each scrape
+class CallbackFamily : public MetricFamilyBase {
+  public:
+    CallbackFamily(std::string name, std::string help, MetricType type,
+                   std::function<double()> fn)
+        : MetricFamilyBase(std::move(name), std::move(help), type, {}),
+          fn_{std::move(fn)} {}
+
+  protected:
+    void renderSamples(std::string& out) const override {
+      this->appendSample(out, "", "", "", this->fn_());
+    }
+
+  private:
+    std::function<double()> fn_;
+};
+}  // namespace
+
+std::size_t metricShard() {
+  thread_local const std::size_t shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+  return shard;
+}
+
+std::uint64_t Counter::value() const {
+  std::uint64_t total = 0;
+  for (const auto& slot : this->shards_) {
+    total += slot.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void Gauge::add(double v) {
+  double current = this->value_.load(std::memory_order_relaxed);
+  while (!this->value_.compare_exchange_weak(current, current + v,
+                                             std::memory_order_relaxed)) {
+  }
+}
+
+Histogram::Histogram(std::vector<double> bounds) : bounds_{std::move(bounds)} {
+  if (this->bounds_.size() > MAX_HISTOGRAM_BUCKETS ||
+      !std::is_sorted(this->bounds_.begin(), this->bounds_.end())) {
+    throw std::invalid_argument("histogram bounds must be ascending, at most " +
+                                std::to_string(MAX_HISTOGRAM_BUCKETS));
+  }
+}
+
+void Histogram::observe(double v) {
+  // first bound >= v, the +Inf slot past the last one
+  const std::size_t bucket =
+      std::lower_bound(this->bounds_.begin(), this->bounds_.end(), v) -
+      this->bounds_.begin();
+  Slot& slot = this->shards_[metricShard()];
+  slot.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  double sum = slot.sum.load(std::memory_order_relaxed);
+  while (!slot.sum.compare_exchange_weak(sum, sum + v,
+                                         std::memory_order_relaxed)) {
+  }
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+  Snapshot s;
+  s.bounds = this->bounds_;
+  s.buckets.assign(this->bounds_.size() + 1, 0);
+  for (const auto& slot : this->shards_) {
+    for (std::size_t i = 0; i < s.buckets.size(); i++) {
+      s.buckets[i] += slot.buckets[i].load(std::memory_order_relaxed);
+    }
+    s.sum += slot.sum.load(std::memory_order_relaxed);
+  }
+  for (std::size_t i = 1; i < s.buckets.size(); i++) {
+    s.buckets[i] += s.buckets[i - 1];
+  }
+  s.count = s.buckets.back();
+  return s;
+}
+
+const std::vector<double>& latencyBuckets() {
+  static const std::vector<double> bounds{0.0001, 0.00025, 0.0005, 0.001,
+                                          0.0025, 0.005,   0.01,   0.025,
+                                          0.05,   0.1,     0.25,   0.5,
+                                          1,      2.5,     5,      10};
+  return bounds;
+}
+
+MetricFamilyBase::MetricFamilyBase(std::string name, std::string help,
+                                   MetricType type,
+                                   std::vector<std::string> labelNames)
+    : name_{std::move(name)},
+      help_{std::move(help)},
+      type_{type},
+      label_names_{std::move(labelNames)} {}
+
+void MetricFamilyBase::render(std::string& out) const {
+  out += "# HELP ";
+  out += this->name_;
+  out += ' ';
+  appendEscaped(out, this->help_, false);
+  out += "\n# TYPE ";
+  out += this->name_;
+  out += ' ';
+  out += typeName(this->type_);
+  out += '\n';
+  this->renderSamples(out);
+}
+
+void MetricFamilyBase::appendSample(std::string& out, std::string_view suffix,
+                                    std::string_view labelKey,
+                                    std::string_view extra,
+                                    double value) const {
+  out += this->name_;
+  out += suffix;
+  if (!this->label_names_.empty() || !extra.empty()) {
+    out += '{';
+    bool first = true;
+    // labelKey holds the values, each followed by \x1f
+    for (const auto& label : this->label_names_) {
+      const std::size_t end = labelKey.find('\x1f');
+      if (!first) out += ',';
+      first = false;
+      out += label;
+      out += "=\"";
+      appendEscaped(out, labelKey.substr(0, end), true);
+      out += '"';
+      labelKey.remove_prefix(end == std::string_view::npos ? labelKey.size()
+                                                           : end + 1);
+    }
+    if (!extra.empty()) {
+      if (!first) out += ',';
+      out += extra;
+    }
+    out += '}';
+  }
+  out += ' ';
+  appendValue(out, value);
+  out += '\n';
+}
+
+template <>
+void MetricFamily<Counter>::renderSamples(std::string& out) const {
+  std::shared_lock<std::shared_mutex> lock(this->mtx_);
+  for (const auto& [key, counter] : this->children_) {
+    this->appendSample(out, "", key, "", double(counter->value()));
+  }
+}
+
+template <>
+void MetricFamily<Gauge>::renderSamples(std::string& out) const {
+  std::shared_lock<std::shared_mutex> lock(this->mtx_);
+  for (const auto& [key, gauge] : this->children_) {
+    this->appendSample(out, "", key, "", gauge->value());
+  }
+}
+
+template <>
+void MetricFamily<Histogram>::renderSamples(std::string& out) const {
+  std::shared_lock<std::shared_mutex> lock(this->mtx_);
+  for (const auto& [key, histogram] : this->children_) {
+    const auto s = histogram->snapshot();
+    for (std::size_t i = 0; i < s.buckets.size(); i++) {
+      std::string le = "le=\"";
+      if (i < s.bounds.size()) {
+        appendValue(le, s.bounds[i]);
+      } else {
+        le += "+Inf";
+      }
+      le += '"';
+      this->appendSample(out, "_bucket", key, le, double(s.buckets[i]));
+    }
+    this->appendSample(out, "_sum", key, "", s.sum);
+    this->appendSample(out, "_count", key, "", double(s.count));
+  }
+}
+
+template <typename Family, typename... Args>
+Family& MetricsRegistry::family(const std::string& name, Args&&... args) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  for (const auto& existing : this->families_) {
+    if (existing->name() != name) continue;
+    if (auto* same = dynamic_cast<Family*>(existing.get())) return *same;
+    throw std::invalid_argument("metric " + name +
+                                " is registered with another type");
+  }
+  auto created = std::make_unique<Family>(name, std::forward<Args>(args)...);
+  Family& ref = *created;
+  this->families_.push_back(std::move(created));
+  return ref;
+}
+
+MetricFamily<Counter>& MetricsRegistry::counter(
+    const std::string& name, const std::string& help,
+    std::vector<std::string> labelNames) {
+  return this->family<MetricFamily<Counter>>(
+      name, help, MetricType::Counter, std::move(labelNames),
+      [] { return std::make_unique<Counter>(); });
+}
+
+MetricFamily<Gauge>& MetricsRegistry::gauge(
+    const std::string& name, const std::string& help,
+    std::vector<std::string> labelNames) {
+  return this->family<MetricFamily<Gauge>>(
+      name, help, MetricType::Gauge, std::move(labelNames),
+      [] { return std::make_unique<Gauge>(); });
+}
+
+MetricFamily<Histogram>& MetricsRegistry::histogram(
+    const std::string& name, const std::string& help,
+    std::vector<std::string> labelNames, std::vector<double> bounds) {
+  // checked now rather than at the first observation
+  Histogram check{bounds};
+  return this->family<MetricFamily<Histogram>>(
+      name, help, MetricType::Histogram, std::move(labelNames),
+      [bounds = std::move(bounds)] {
+        return std::make_unique<Histogram>(bounds);
+      });
+}
+
+void MetricsRegistry::callback(const std::string& name,
+                               const std::string& help, MetricType type,
+                               std::function<double()> fn) {
+  this->family<CallbackFamily>(name, help, type, std::move(fn));
+}
+
+void MetricsRegistry::render(std::string& out) const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  for (const auto& family : this->families_) {
+    family->render(out);
+  }
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+}  // namespace cc::utils
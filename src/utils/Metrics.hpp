@@ -0,0 +1,211 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace cc::utils {
+
+// Updates of counters and histograms go to one of METRIC_SHARDS cache line
+// sized slots picked per thread, so threads rarely write the same line;
+// reads (a scrape) sum the slots.
+inline constexpr std::size_t METRIC_SHARDS = 16;
+inline constexpr std::size_t MAX_HISTOGRAM_BUCKETS = 16;
+// label sets per family, later ones are counted under "other"
+inline constexpr std::size_t MAX_LABEL_SETS = 256;
+
+// slot of the calling thread, assigned round robin on first use
+std::size_t metricShard();
+
+class Counter {
+  public:
+    void inc(std::uint64_t n = 1) {
+        this->shards_[metricShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    std::uint64_t value() const;
+
+  private:
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Slot, METRIC_SHARDS> shards_;
+};
+
+// A value that goes up and down. Not sharded: set() needs a single cell.
+class Gauge {
+  public:
+    void set(double v) { this->value_.store(v, std::memory_order_relaxed); }
+    void add(double v);
+    void inc() { this->add(1); }
+    void dec() { this->add(-1); }
+    double value() const { return this->value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<double> value_{0};
+};
+
+// Counts observations per upper bound (le), cumulated when read.
+class Histogram {
+  public:
+    // at most MAX_HISTOGRAM_BUCKETS ascending bounds, +Inf is implicit
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double v);
+    template <typename Rep, typename Period> void observe(std::chrono::duration<Rep, Period> d) {
+        this->observe(std::chrono::duration<double>(d).count());
+    }
+
+    struct Snapshot {
+        std::vector<double> bounds;
+        // cumulative, one more than bounds (+Inf)
+        std::vector<std::uint64_t> buckets;
+        double sum{0};
+        std::uint64_t count{0};
+    };
+    Snapshot snapshot() const;
+
+  private:
+    struct alignas(64) Slot {
+        std::array<std::atomic<std::uint64_t>, MAX_HISTOGRAM_BUCKETS + 1> buckets{};
+        std::atomic<double> sum{0};
+    };
+    std::vector<double> bounds_;
+    std::array<Slot, METRIC_SHARDS> shards_;
+};
+
+// seconds, from 0.1 ms (cache hits) to 10 s (OpenFoodFacts timeouts)
+const std::vector<double>& latencyBuckets();
+
+// Observes the time from construction to destruction in seconds.
+class HistogramTimer {
+  public:
+    explicit HistogramTimer(Histogram& histogram)
+        : histogram_{histogram}, start_{std::chrono::steady_clock::now()} {}
+    ~HistogramTimer() { this->histogram_.observe(std::chrono::steady_clock::now() - this->start_); }
+
+    HistogramTimer(const HistogramTimer&) = delete;
+    HistogramTimer& operator=(const HistogramTimer&) = delete;
+
+  private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+enum class MetricType : std::uint8_t { Counter, Gauge, Histogram };
+
+class MetricFamilyBase {
+  public:
+    MetricFamilyBase(std::string name, std::string help, MetricType type,
+                     std::vector<std::string> labelNames);
+    virtual ~MetricFamilyBase() = default;
+
+    const std::string& name() const { return this->name_; }
+    MetricType type() const { return this->type_; }
+    // HELP, TYPE and the samples in Prometheus text format
+    void render(std::string& out) const;
+
+  protected:
+    virtual void renderSamples(std::string& out) const = 0;
+    // name{label="value",...extra} value
+    void appendSample(std::string& out, std::string_view suffix, std::string_view labelKey,
+                      std::string_view extra, double value) const;
+
+    std::string name_;
+    std::string help_;
+    MetricType type_;
+    std::vector<std::string> label_names_;
+};
+
+// One metric per combination of label values, created on first use. Keep
+// the reference when the labels are fixed: lookups take a shared lock.
+template <typename Metric> class MetricFamily : public MetricFamilyBase {
+  public:
+    MetricFamily(std::string name, std::string help, MetricType type,
+                 std::vector<std::string> labelNames, std::function<std::unique_ptr<Metric>()> make)
+        : MetricFamilyBase(std::move(name), std::move(help), type, std::move(labelNames)),
+          make_{std::move(make)} {}
+
+    // values in the order of the label names
+    Metric& labels(std::initializer_list<std::string_view> values) {
+        thread_local std::string key;
+        key.clear();
+        for (std::string_view v : values) {
+            key += v;
+            key += '\x1f';
+        }
+        {
+            std::shared_lock<std::shared_mutex> lock(this->mtx_);
+            auto it = this->children_.find(key);
+            if (it != this->children_.end()) return *it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(this->mtx_);
+        if (this->children_.size() >= MAX_LABEL_SETS && !this->children_.contains(key)) {
+            key.clear();
+            for (std::size_t i = 0; i < values.size(); i++) key += "other\x1f";
+        }
+        auto& child = this->children_[key];
+        if (!child) child = this->make_();
+        return *child;
+    }
+
+    Metric& get() { return this->labels({}); }
+
+  protected:
+    void renderSamples(std::string& out) const override;
+
+  private:
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    mutable std::shared_mutex mtx_;
+    std::unordered_map<std::string, std::unique_ptr<Metric>, KeyHash, std::equal_to<>> children_;
+    std::function<std::unique_ptr<Metric>()> make_;
+};
+
+template <> void MetricFamily<Counter>::renderSamples(std::string& out) const;
+template <> void MetricFamily<Gauge>::renderSamples(std::string& out) const;
+template <> void MetricFamily<Histogram>::renderSamples(std::string& out) const;
+
+// Named families rendered together at /metrics. Registering a name twice
+// returns the first family, so call sites may register lazily.
+class MetricsRegistry {
+  public:
+    MetricFamily<Counter>& counter(const std::string& name, const std::string& help,
+                                   std::vector<std::string> labelNames = {});
+    MetricFamily<Gauge>& gauge(const std::string& name, const std::string& help,
+                               std::vector<std::string> labelNames = {});
+    MetricFamily<Histogram>& histogram(const std::string& name, const std::string& help,
+                                       std::vector<std::string> labelNames = {},
+                                       std::vector<double> bounds = latencyBuckets());
+    // a counter or gauge read from fn at each scrape, for values another
+    // component already keeps (cache sizes, queue depths)
+    void callback(const std::string& name, const std::string& help, MetricType type,
+                  std::function<double()> fn);
+
+    // Prometheus text exposition format 0.0.4
+    void render(std::string& out) const;
+
+    // counters of the services, clients and repositories
+    static MetricsRegistry& global();
+
+  private:
+    template <typename Family, typename... Args>
+    Family& family(const std::string& name, Args&&... args);
+
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<MetricFamilyBase>> families_;
+};
+
+} // namespace cc::utils
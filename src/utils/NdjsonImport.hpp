@@ -0,0 +1,108 @@
+#pragma once
+#include "nlohmann/json.hpp"
+#include "utils/Result.hpp"
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cc::utils {
+
+struct ImportReport {
+    struct LineError {
+        std::size_t line; // 1 based
+        std::string message;
+    };
+
+    std::size_t lines{0}; // non blank lines
+    std::size_t imported{0};
+    std::size_t failed{0};
+    std::size_t batches{0}; // writes to the repository
+    std::chrono::nanoseconds elapsed{0};
+    // the first kMaxErrors failures, `failed` counts all of them
+    std::vector<LineError> errors;
+    static constexpr std::size_t kMaxErrors = 1000;
+
+    double recordsPerSecond() const {
+        const double seconds = std::chrono::duration<double>(this->elapsed).count();
+        return seconds > 0 ? double(this->imported) / seconds : 0.0;
+    }
+};
+
+// calls fn(lineNumber, line) for every non blank line of an NDJSON text,
+// without the line break (\n or \r\n)
+template <typename Fn> void forEachNdjsonLine(std::string_view text, Fn&& fn) {
+    std::size_t number = 0;
+    while (!text.empty()) {
+        const std::size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text = eol == std::string_view::npos ? std::string_view{} : text.substr(eol + 1);
+        number++;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.find_first_not_of(" \t") == std::string_view::npos) continue;
+        fn(number, line);
+    }
+}
+
+// Parses an NDJSON body one line at a time and applies the valid records
+// in batches of batchSize, so a large import costs one storage write per
+// batch instead of one per record. Lines that are not JSON or fail `parse`
+// are reported and skipped; if `apply` fails, every line of that batch is.
+//   parse: Result<Record>(const nlohmann::json&)
+//   apply: Result<void>(std::span<const Record>)
+template <typename Record, typename Parse, typename Apply>
+ImportReport importNdjson(std::string_view body, std::size_t batchSize, Parse&& parse,
+                          Apply&& apply) {
+    const auto start = std::chrono::steady_clock::now();
+    ImportReport report;
+    auto fail = [&report](std::size_t line, std::string message) {
+        report.failed++;
+        if (report.errors.size() < ImportReport::kMaxErrors) {
+            report.errors.push_back({line, std::move(message)});
+        }
+    };
+
+    batchSize = batchSize > 0 ? batchSize : 1;
+    std::vector<Record> batch;
+    std::vector<std::size_t> batch_lines;
+    batch.reserve(batchSize);
+    batch_lines.reserve(batchSize);
+    auto flush = [&]() {
+        if (batch.empty()) return;
+        Result<void> applied = apply(std::span<const Record>(batch));
+        report.batches++;
+        if (applied) {
+            report.imported += batch.size();
+        } else {
+            for (std::size_t line : batch_lines) fail(line, applied.unwrap_error().message);
+        }
+        batch.clear();
+        batch_lines.clear();
+    };
+
+    forEachNdjsonLine(body, [&](std::size_t number, std::string_view line) {
+        report.lines++;
+        nlohmann::json record = nlohmann::json::parse(line, nullptr, false);
+        if (record.is_discarded()) {
+            fail(number, "invalid JSON");
+            return;
+        }
+        Result<Record> parsed = parse(record);
+        if (!parsed) {
+            fail(number, parsed.unwrap_error().message);
+            return;
+        }
+        batch.push_back(std::move(*parsed.value));
+        batch_lines.push_back(number);
+        if (batch.size() == batchSize) flush();
+    });
+    flush();
+
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+} // namespace cc::utils
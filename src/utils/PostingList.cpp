@@ -0,0 +1,140 @@
+#include "utils/PostingList.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace cc::utils {
+
+namespace {
+std::uint16_t highBits(std::uint32_t id) { return static_cast<std::uint16_t>(id >> 16); }
+std::uint16_t lowBits(std::uint32_t id) { return static_cast<std::uint16_t>(id & 0xFFFF); }
+}  // namespace
+
+bool PostingList::Container::add(std::uint16_t low) {
+  if (this->isBitmap()) {
+    std::uint64_t& word = this->bitmap[low >> 6];
+    const std::uint64_t bit = std::uint64_t{1} << (low & 63);
+    if (word & bit) return false;
+    word |= bit;
+  } else {
+    auto it = std::lower_bound(this->array.begin(), this->array.end(), low);
+    if (it != this->array.end() && *it == low) return false;
+    this->array.insert(it, low);
+    if (this->array.size() > kArrayMax) {
+      // too dense for an array, a bitmap is smaller and O(1)
+      this->bitmap.assign(kBitmapWords, 0);
+      for (std::uint16_t v : this->array) {
+        this->bitmap[v >> 6] |= std::uint64_t{1} << (v & 63);
+      }
+      this->array.clear();
+      this->array.shrink_to_fit();
+    }
+  }
+  this->cardinality++;
+  return true;
+}
+
+bool PostingList::Container::remove(std::uint16_t low) {
+  if (this->isBitmap()) {
+    std::uint64_t& word = this->bitmap[low >> 6];
+    const std::uint64_t bit = std::uint64_t{1} << (low & 63);
+    if (!(word & bit)) return false;
+    word &= ~bit;
+    this->cardinality--;
+    if (this->cardinality <= kArrayMax / 2) {
+      // back to an array, with some hysteresis so add/remove does not flip
+      for (std::size_t w = 0; w < kBitmapWords; w++) {
+        for (std::uint64_t bits = this->bitmap[w]; bits != 0; bits &= bits - 1) {
+          this->array.push_back(static_cast<std::uint16_t>(w * 64 + std::countr_zero(bits)));
+        }
+      }
+      this->bitmap.clear();
+      this->bitmap.shrink_to_fit();
+    }
+    return true;
+  }
+  auto it = std::lower_bound(this->array.begin(), this->array.end(), low);
+  if (it == this->array.end() || *it != low) return false;
+  this->array.erase(it);
+  this->cardinality--;
+  return true;
+}
+
+bool PostingList::Container::contains(std::uint16_t low) const {
+  if (this->isBitmap()) {
+    return (this->bitmap[low >> 6] >> (low & 63)) & 1;
+  }
+  return std::binary_search(this->array.begin(), this->array.end(), low);
+}
+
+bool PostingList::add(std::uint32_t id) {
+  const std::uint16_t high = highBits(id);
+  auto it = std::lower_bound(
+      this->containers_.begin(), this->containers_.end(), high,
+      [](const auto& c, std::uint16_t key) { return c.first < key; });
+  if (it == this->containers_.end() || it->first != high) {
+    it = this->containers_.insert(it, {high, Container{}});
+  }
+  if (!it->second.add(lowBits(id))) return false;
+  this->size_++;
+  return true;
+}
+
+bool PostingList::remove(std::uint32_t id) {
+  const std::uint16_t high = highBits(id);
+  auto it = std::lower_bound(
+      this->containers_.begin(), this->containers_.end(), high,
+      [](const auto& c, std::uint16_t key) { return c.first < key; });
+  if (it == this->containers_.end() || it->first != high) return false;
+  if (!it->second.remove(lowBits(id))) return false;
+  if (it->second.cardinality == 0) {
+    this->containers_.erase(it);
+  }
+  this->size_--;
+  return true;
+}
+
+bool PostingList::contains(std::uint32_t id) const {
+  const std::uint16_t high = highBits(id);
+  auto it = std::lower_bound(
+      this->containers_.begin(), this->containers_.end(), high,
+      [](const auto& c, std::uint16_t key) { return c.first < key; });
+  return it != this->containers_.end() && it->first == high &&
+         it->second.contains(lowBits(id));
+}
+
+std::size_t PostingList::size() const { return this->size_; }
+
+bool PostingList::empty() const { return this->size_ == 0; }
+
+std::vector<std::uint32_t> PostingList::values() const {
+  std::vector<std::uint32_t> out;
+  out.reserve(this->size_);
+  for (const auto& [high, container] : this->containers_) {
+    const std::uint32_t base = std::uint32_t{high} << 16;
+    if (container.isBitmap()) {
+      for (std::size_t w = 0; w < kBitmapWords; w++) {
+        for (std::uint64_t bits = container.bitmap[w]; bits != 0; bits &= bits - 1) {
+          out.push_back(base | static_cast<std::uint32_t>(w * 64 + std::countr_zero(bits)));
+        }
+      }
+    } else {
+      for (std::uint16_t low : container.array) {
+        out.push_back(base | low);
+      }
+    }
+  }
+  return out;
+}
+
+std::size_t PostingList::approximateBytes() const {
+  std::size_t bytes = sizeof(*this);
+  for (const auto& [high, container] : this->containers_) {
+    bytes += sizeof(high) + sizeof(container) +
+             container.array.capacity() * sizeof(std::uint16_t) +
+             container.bitmap.capacity() * sizeof(std::uint64_t);
+  }
+  return bytes;
+}
+
+}  // namespace cc::utils
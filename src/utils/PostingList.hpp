@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cc::utils {
+
+// Compressed sorted set of 32 bit ids, organised like a roaring bitmap: ids
+// are grouped by their high 16 bits and each group is stored either as a
+// sorted array of the low 16 bits (sparse) or as a 65536 bit bitmap (dense).
+class PostingList {
+  public:
+    // false if the id was already there
+    bool add(std::uint32_t id);
+    // false if the id was not there
+    bool remove(std::uint32_t id);
+    bool contains(std::uint32_t id) const;
+
+    std::size_t size() const;
+    bool empty() const;
+    // all ids in ascending order
+    std::vector<std::uint32_t> values() const;
+    std::size_t approximateBytes() const;
+
+  private:
+    // above this many ids an array container becomes a bitmap
+    static constexpr std::size_t kArrayMax = 4096;
+    static constexpr std::size_t kBitmapWords = 65536 / 64;
+
+    struct Container {
+        std::vector<std::uint16_t> array; // sorted, used while bitmap is empty
+        std::vector<std::uint64_t> bitmap;
+        std::size_t cardinality{0};
+
+        bool isBitmap() const { return !this->bitmap.empty(); }
+        bool add(std::uint16_t low);
+        bool remove(std::uint16_t low);
+        bool contains(std::uint16_t low) const;
+    };
+
+    // sorted by the high 16 bits
+    std::vector<std::pair<std::uint16_t, Container>> containers_;
+    std::size_t size_{0};
+};
+
+} // namespace cc::utils
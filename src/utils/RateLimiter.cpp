@@ -0,0 +1,91 @@
+#include "utils/RateLimiter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace cc::utils {
+
+namespace {
+bool parseNumber(std::string_view s, double& out) {
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+  return ec == std::errc{} && ptr == s.data() + s.size() && out >= 0 &&
+         std::isfinite(out);
+}
+}  // namespace
+
+Result<RateLimit> parseRateLimit(std::string_view text) {
+  const std::size_t colon = text.find(':');
+  RateLimit limit;
+  if (!parseNumber(text.substr(0, colon), limit.ratePerSecond)) {
+    return Result<RateLimit>::fail(
+        ErrorCode::InvalidInput,
+        "invalid rate '" + std::string(text.substr(0, colon)) + "'");
+  }
+  limit.burst = std::max(1.0, limit.ratePerSecond);
+  if (colon != std::string_view::npos &&
+      (!parseNumber(text.substr(colon + 1), limit.burst) || limit.burst < 1)) {
+    return Result<RateLimit>::fail(
+        ErrorCode::InvalidInput,
+        "invalid burst '" + std::string(text.substr(colon + 1)) + "'");
+  }
+  return Result<RateLimit>::ok(limit);
+}
+
+RateLimiter::RateLimiter(RateLimit limit, std::size_t maxKeys)
+    : limit_{limit},
+      max_keys_per_shard_{std::max<std::size_t>(1, maxKeys / SHARDS)} {}
+
+RateLimiter::Decision RateLimiter::acquire(std::string_view key,
+                                           clock::time_point now) {
+  if (!this->limit_.enabled()) return {};
+  Shard& shard = this->shards_[std::hash<std::string_view>{}(key) % SHARDS];
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  auto it = shard.buckets.find(key);
+  if (it == shard.buckets.end()) {
+    if (shard.buckets.size() >= this->max_keys_per_shard_) {
+      this->prune(shard, now);
+    }
+    it = shard.buckets
+             .emplace(std::string(key), Bucket{this->limit_.burst, now})
+             .first;
+  }
+  Bucket& bucket = it->second;
+  const double elapsed =
+      std::chrono::duration<double>(now - bucket.updated).count();
+  if (elapsed > 0) {
+    bucket.tokens = std::min(
+        this->limit_.burst, bucket.tokens + elapsed * this->limit_.ratePerSecond);
+    bucket.updated = now;
+  }
+  if (bucket.tokens >= 1) {
+    bucket.tokens -= 1;
+    return {};
+  }
+  const double wait = (1 - bucket.tokens) / this->limit_.ratePerSecond;
+  return {false, std::chrono::duration_cast<clock::duration>(
+                     std::chrono::duration<double>(wait))};
+}
+
+std::size_t RateLimiter::size() const {
+  std::size_t total = 0;
+  for (const auto& shard : this->shards_) {
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    total += shard.buckets.size();
+  }
+  return total;
+}
+
+void RateLimiter::prune(Shard& shard, clock::time_point now) {
+  // a bucket idle long enough to be full again is the same as a new one
+  const auto refill = std::chrono::duration<double>(this->limit_.burst /
+                                                    this->limit_.ratePerSecond);
+  std::erase_if(shard.buckets, [&](const auto& entry) {
+    return now - entry.second.updated >= refill;
+  });
+  while (shard.buckets.size() >= this->max_keys_per_shard_) {
+    shard.buckets.erase(shard.buckets.begin());
+  }
+}
+
+}  // namespace cc::utils
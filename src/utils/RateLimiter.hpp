@@ -0,0 +1,73 @@
+#pragma once
+#include "utils/Result.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cc::utils {
+
+// Sustained requests per second and how many may come at once.
+struct RateLimit {
+    double ratePerSecond{0};
+    double burst{1};
+
+    // a zero rate means no limit
+    bool enabled() const { return this->ratePerSecond > 0; }
+};
+
+// "rate:burst" like "5:10", or "rate" with a burst of max(1, rate)
+Result<RateLimit> parseRateLimit(std::string_view text);
+
+// One token bucket per key (a client, a client on a route). Buckets start
+// full, refill at the rate up to the burst, and a request takes one token.
+// Keys are spread over mutex guarded shards; idle buckets are dropped once
+// a shard holds more than its share of maxKeys.
+class RateLimiter {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct Decision {
+        bool allowed{true};
+        // until the next token when refused
+        clock::duration retryAfter{};
+    };
+
+    explicit RateLimiter(RateLimit limit, std::size_t maxKeys = 100000);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    Decision acquire(std::string_view key, clock::time_point now = clock::now());
+    RateLimit limit() const { return this->limit_; }
+    std::size_t size() const;
+
+  private:
+    static constexpr std::size_t SHARDS = 16;
+
+    struct Bucket {
+        double tokens;
+        clock::time_point updated;
+    };
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+    struct alignas(64) Shard {
+        mutable std::mutex mtx;
+        std::unordered_map<std::string, Bucket, KeyHash, std::equal_to<>> buckets;
+    };
+
+    // drops the buckets that refilled, then any until the shard fits
+    void prune(Shard& shard, clock::time_point now);
+
+    RateLimit limit_;
+    std::size_t max_keys_per_shard_;
+    std::array<Shard, SHARDS> shards_;
+};
+
+} // namespace cc::utils
@@ -0,0 +1,81 @@
+#include "utils/RequestTiming.hpp"
+
+#include <format>
+
+namespace cc::utils {
+
+namespace {
+thread_local RequestTimings* current_timings = nullptr;
+
+constexpr std::array<std::string_view, TIMING_PHASES> PHASE_NAMES = {
+    "parse", "storage", "off", "enrich", "serialize", "compress"};
+
+std::size_t index(TimingPhase phase) { return static_cast<std::size_t>(phase); }
+}  // namespace
+
+std::string_view timingPhaseName(TimingPhase phase) {
+  return PHASE_NAMES[index(phase)];
+}
+
+void RequestTimings::charge(clock::time_point now) {
+  if (this->active_) this->durations_[index(*this->active_)] += now - this->since_;
+  this->since_ = now;
+}
+
+void RequestTimings::enter(TimingPhase phase) {
+  this->charge(clock::now());
+  this->active_ = phase;
+  this->counts_[index(phase)]++;
+}
+
+void RequestTimings::leave(std::optional<TimingPhase> previous) {
+  this->charge(clock::now());
+  this->active_ = previous;
+}
+
+std::optional<TimingPhase> RequestTimings::active() const {
+  return this->active_;
+}
+
+RequestTimings::clock::duration RequestTimings::duration(
+    TimingPhase phase) const {
+  return this->durations_[index(phase)];
+}
+
+std::uint32_t RequestTimings::count(TimingPhase phase) const {
+  return this->counts_[index(phase)];
+}
+
+RequestTimings* currentRequestTimings() { return current_timings; }
+
+RequestTimings* bindRequestTimings(RequestTimings* timings) {
+  RequestTimings* previous = current_timings;
+  current_timings = timings;
+  return previous;
+}
+
+PhaseTimer::PhaseTimer(TimingPhase phase) : timings_{current_timings} {
+  if (!this->timings_) return;
+  this->previous_ = this->timings_->active();
+  this->timings_->enter(phase);
+}
+
+PhaseTimer::~PhaseTimer() {
+  if (this->timings_) this->timings_->leave(this->previous_);
+}
+
+std::string formatServerTiming(const RequestTimings& timings,
+                               RequestTimings::clock::duration total) {
+  using ms = std::chrono::duration<double, std::milli>;
+  std::string out;
+  for (std::size_t i = 0; i < TIMING_PHASES; i++) {
+    const auto phase = static_cast<TimingPhase>(i);
+    if (timings.count(phase) == 0) continue;
+    out += std::format("{};dur={:.3f}, ", PHASE_NAMES[i],
+                       ms(timings.duration(phase)).count());
+  }
+  out += std::format("total;dur={:.3f}", ms(total).count());
+  return out;
+}
+
+}  // namespace cc::utils
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cc::utils {
+
+// Where the time of a request goes, as reported in Server-Timing.
+enum class TimingPhase : std::uint8_t { Parse, Storage, OffFetch, Enrich, Serialize, Compress };
+inline constexpr std::size_t TIMING_PHASES = 6;
+
+// metric name in Server-Timing: parse, storage, off, enrich, serialize, compress
+std::string_view timingPhaseName(TimingPhase phase);
+
+// Exclusive time per phase of one request: entering a phase pauses the one
+// it is nested in, so storage read while enriching counts as storage only.
+class RequestTimings {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    void enter(TimingPhase phase);
+    // back to the phase active before the matching enter()
+    void leave(std::optional<TimingPhase> previous);
+    std::optional<TimingPhase> active() const;
+
+    clock::duration duration(TimingPhase phase) const;
+    // number of times the phase was entered
+    std::uint32_t count(TimingPhase phase) const;
+
+  private:
+    void charge(clock::time_point now);
+
+    std::array<clock::duration, TIMING_PHASES> durations_{};
+    std::array<std::uint32_t, TIMING_PHASES> counts_{};
+    std::optional<TimingPhase> active_;
+    clock::time_point since_;
+};
+
+// timings of the request handled by the calling thread, nullptr outside one
+RequestTimings* currentRequestTimings();
+// binds timings to the calling thread, returns the previous binding
+RequestTimings* bindRequestTimings(RequestTimings* timings);
+
+// Times a scope as one phase of the current request; a no-op when the
+// thread is not handling a request (tests, background workers).
+class PhaseTimer {
+  public:
+    explicit PhaseTimer(TimingPhase phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+  private:
+    RequestTimings* timings_;
+    std::optional<TimingPhase> previous_;
+};
+
+// "parse;dur=0.012, storage;dur=1.5, total;dur=2.1": the entered phases
+// in milliseconds, then the total
+std::string formatServerTiming(const RequestTimings& timings, RequestTimings::clock::duration total);
+
+} // namespace cc::utils
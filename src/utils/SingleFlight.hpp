@@ -0,0 +1,64 @@
+#pragma once
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace cc::utils {
+
+// Coalesces concurrent calls for the same key: the first caller runs the
+// work, the others block on its shared result instead of repeating it.
+template <typename Key, typename Value> class SingleFlight {
+  public:
+    // runs fn() once per key for all callers that overlap in time
+    // shared is set to true when the result came from another caller
+    template <typename Fn> Value run(const Key& key, Fn&& fn, bool* shared = nullptr) {
+        std::promise<Value> promise;
+        {
+            std::unique_lock<std::mutex> lock(this->mtx_);
+            auto it = this->calls_.find(key);
+            if (it != this->calls_.end()) {
+                std::shared_future<Value> pending = it->second;
+                lock.unlock();
+                if (shared) {
+                    *shared = true;
+                }
+                return pending.get();
+            }
+            this->calls_.emplace(key, promise.get_future().share());
+        }
+        if (shared) {
+            *shared = false;
+        }
+        try {
+            Value value = std::forward<Fn>(fn)();
+            promise.set_value(value);
+            this->forget(key);
+            return value;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            this->forget(key);
+            throw;
+        }
+    }
+
+    // number of keys currently being computed
+    std::size_t inFlight() const {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        return this->calls_.size();
+    }
+
+  private:
+    void forget(const Key& key) {
+        std::lock_guard<std::mutex> lock(this->mtx_);
+        this->calls_.erase(key);
+    }
+
+    mutable std::mutex mtx_;
+    std::unordered_map<Key, std::shared_future<Value>> calls_;
+};
+
+} // namespace cc::utils
@@ -0,0 +1,155 @@
+#include "utils/ThreadLayout.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cc::utils {
+
+namespace {
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\n')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\n')) s.remove_suffix(1);
+  return s;
+}
+
+bool parseCpu(std::string_view s, int& cpu) {
+  s = trim(s);
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), cpu);
+  return ec == std::errc{} && ptr == s.data() + s.size() && cpu >= 0;
+}
+}  // namespace
+
+Result<std::vector<int>> parseCpuList(std::string_view text) {
+  std::vector<int> cpus;
+  text = trim(text);
+  while (!text.empty()) {
+    const std::size_t comma = text.find(',');
+    std::string_view range = text.substr(0, comma);
+    text = comma == std::string_view::npos ? std::string_view{}
+                                           : text.substr(comma + 1);
+    const std::size_t dash = range.find('-');
+    int first = 0;
+    int last = 0;
+    if (!parseCpu(range.substr(0, dash), first) ||
+        (dash != std::string_view::npos &&
+         !parseCpu(range.substr(dash + 1), last))) {
+      return Result<std::vector<int>>::fail(
+          ErrorCode::InvalidInput,
+          "invalid cpu list entry '" + std::string(range) + "'");
+    }
+    if (dash == std::string_view::npos) last = first;
+    if (last < first) {
+      return Result<std::vector<int>>::fail(
+          ErrorCode::InvalidInput,
+          "descending cpu range '" + std::string(range) + "'");
+    }
+    for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+  }
+  if (cpus.empty()) {
+    return Result<std::vector<int>>::fail(ErrorCode::InvalidInput,
+                                          "empty cpu list");
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return Result<std::vector<int>>::ok(std::move(cpus));
+}
+
+Result<std::vector<int>> numaNodeCpus(int node) {
+  const std::string path =
+      "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+  std::ifstream in(path);
+  if (!in) {
+    return Result<std::vector<int>>::fail(
+        ErrorCode::NotFound, "no NUMA node " + std::to_string(node));
+  }
+  std::string list(std::istreambuf_iterator<char>(in), {});
+  return parseCpuList(list);
+}
+
+Result<std::vector<int>> parseCpuSpec(std::string_view text) {
+  text = trim(text);
+  if (text.starts_with("node:")) {
+    int node = 0;
+    if (!parseCpu(text.substr(5), node)) {
+      return Result<std::vector<int>>::fail(
+          ErrorCode::InvalidInput,
+          "invalid NUMA node '" + std::string(text.substr(5)) + "'");
+    }
+    return numaNodeCpus(node);
+  }
+  return parseCpuList(text);
+}
+
+std::string formatCpuList(std::span<const int> cpus) {
+  std::string out;
+  for (std::size_t i = 0; i < cpus.size();) {
+    std::size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+    if (!out.empty()) out += ',';
+    out += std::to_string(cpus[i]);
+    if (j > i) out += '-' + std::to_string(cpus[j]);
+    i = j + 1;
+  }
+  return out;
+}
+
+Result<void> pinCurrentThread(std::span<const int> cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      return Result<void>::fail(ErrorCode::InvalidInput,
+                                "cpu " + std::to_string(cpu) + " out of range");
+    }
+    CPU_SET(cpu, &set);
+  }
+  const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (rc != 0) {
+    return Result<void>::fail(
+        ErrorCode::InvalidInput,
+        "cannot pin to cpus " + formatCpuList(cpus) + " (error " +
+            std::to_string(rc) + ")");
+  }
+  return Result<void>::ok();
+#else
+  return Result<void>::fail(ErrorCode::Unknown,
+                            "thread affinity is not supported here");
+#endif
+}
+
+unsigned hardwareThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+unsigned httpThreads(const ThreadLayout& layout) {
+  const unsigned workers =
+      layout.httpWorkers > 0 ? layout.httpWorkers : hardwareThreads();
+  return workers + 1;
+}
+
+std::string describeLayout(const ThreadLayout& layout,
+                           std::size_t poolThreads) {
+  const std::string where =
+      layout.cpus.empty() ? std::string("any cpu")
+                          : "cpus " + formatCpuList(layout.cpus);
+  std::ostringstream out;
+  out << "threads: " << hardwareThreads() << " hardware\n";
+  out << "  http: 1 acceptor + " << httpThreads(layout) - 1
+      << " workers on " << where << "\n";
+  out << "  pool: " << poolThreads << " workers on " << where;
+  if (layout.pinPool && !layout.cpus.empty()) out << ", one cpu each";
+  out << "\n";
+  return out.str();
+}
+
+}  // namespace cc::utils
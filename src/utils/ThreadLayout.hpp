@@ -0,0 +1,43 @@
+#pragma once
+#include "utils/Result.hpp"
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cc::utils {
+
+// How the server spreads its threads over the machine.
+struct ThreadLayout {
+    // Crow threads running the handlers, next to its one acceptor thread;
+    // 0 = one per hardware thread
+    unsigned httpWorkers{0};
+    // workers of ThreadPool::shared() (OFF lookups, parallel scans), 0 = default
+    unsigned poolThreads{0};
+    // cpus the threads may run on, empty = no restriction
+    std::vector<int> cpus;
+    // pool worker i runs on cpus[i % cpus.size()] only, instead of the set
+    bool pinPool{false};
+};
+
+// "0-3,8,10-11" into sorted, unique cpu ids
+Result<std::vector<int>> parseCpuList(std::string_view text);
+// cpus of a NUMA node, from /sys/devices/system/node/node<N>/cpulist
+Result<std::vector<int>> numaNodeCpus(int node);
+// "node:<N>" or a cpu list
+Result<std::vector<int>> parseCpuSpec(std::string_view text);
+// "0-3,8", the inverse of parseCpuList
+std::string formatCpuList(std::span<const int> cpus);
+
+// restricts the calling thread to the cpus; threads it starts afterwards
+// inherit the mask. Fails on platforms without thread affinity
+Result<void> pinCurrentThread(std::span<const int> cpus);
+
+// at least 1, even where the hardware concurrency is unknown
+unsigned hardwareThreads();
+// Crow threads of a layout: acceptor + workers
+unsigned httpThreads(const ThreadLayout& layout);
+// one line per thread group, printed at startup
+std::string describeLayout(const ThreadLayout& layout, std::size_t poolThreads);
+
+} // namespace cc::utils
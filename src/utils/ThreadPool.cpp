@@ -0,0 +1,111 @@
+#include "utils/ThreadPool.hpp"
+
+#include "utils/ThreadLayout.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace cc::utils {
+
+namespace {
+struct SharedConfig {
+  std::size_t threads{0};
+  std::vector<int> cpus;
+};
+
+std::mutex shared_mtx;
+SharedConfig shared_config;
+bool shared_created = false;
+
+// the configuration shared() is built from, no changes afterwards
+SharedConfig takeSharedConfig() {
+  std::lock_guard<std::mutex> lock(shared_mtx);
+  shared_created = true;
+  SharedConfig config = shared_config;
+  if (config.threads == 0) {
+    // OFF lookups block on the network, so keep a few workers even on
+    // small machines
+    config.threads = std::max(4u, hardwareThreads());
+  }
+  return config;
+}
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) : ThreadPool(threads, {}) {}
+
+ThreadPool::ThreadPool(std::size_t threads, std::vector<int> cpus) {
+  threads = std::max<std::size_t>(1, threads);
+  for (std::size_t i = 0; i < threads; i++) {
+    std::vector<int> own;
+    if (!cpus.empty()) own.push_back(cpus[i % cpus.size()]);
+    this->workers_.emplace_back(
+        [this, own = std::move(own)] { this->workerLoop(own); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->stopping_ = true;
+  }
+  this->cv_.notify_all();
+  for (auto& worker : this->workers_) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+bool ThreadPool::runPendingTask() {
+  std::function<void()> task;
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    if (this->tasks_.empty()) return false;
+    task = std::move(this->tasks_.front());
+    this->tasks_.pop_front();
+  }
+  task();
+  return true;
+}
+
+std::size_t ThreadPool::size() const { return this->workers_.size(); }
+
+std::size_t ThreadPool::pending() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  return this->tasks_.size();
+}
+
+ThreadPool& ThreadPool::shared() {
+  static const SharedConfig config = takeSharedConfig();
+  static ThreadPool pool{config.threads, config.cpus};
+  return pool;
+}
+
+bool ThreadPool::configureShared(std::size_t threads, std::vector<int> cpus) {
+  std::lock_guard<std::mutex> lock(shared_mtx);
+  if (shared_created) return false;
+  shared_config = SharedConfig{threads, std::move(cpus)};
+  return true;
+}
+
+void ThreadPool::workerLoop(std::vector<int> cpus) {
+  if (!cpus.empty()) {
+    // an unusable cpu leaves the worker unpinned rather than failing
+    auto pinned = pinCurrentThread(cpus);
+    if (!pinned) {
+      std::cerr << "thread pool: " << pinned.unwrap_error().message << std::endl;
+    }
+  }
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(this->mtx_);
+      this->cv_.wait(lock,
+                     [this] { return this->stopping_ || !this->tasks_.empty(); });
+      if (this->stopping_ && this->tasks_.empty()) return;
+      task = std::move(this->tasks_.front());
+      this->tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace cc::utils
@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cc::utils {
+
+// Fixed size worker pool shared by the services.
+// Callers waiting on a task help by running queued tasks themselves, so a
+// task may submit sub tasks and wait for them without starving the pool.
+class ThreadPool {
+  public:
+    explicit ThreadPool(std::size_t threads);
+    // worker i only runs on cpus[i % cpus.size()], no pinning when empty
+    ThreadPool(std::size_t threads, std::vector<int> cpus);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename Fn> auto submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>> {
+        using R = std::invoke_result_t<Fn>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+        std::future<R> future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(this->mtx_);
+            this->tasks_.emplace_back([task]() { (*task)(); });
+        }
+        this->cv_.notify_one();
+        return future;
+    }
+
+    // runs queued tasks on the calling thread until the future is ready
+    template <typename T> T wait(std::future<T>& future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!this->runPendingTask()) {
+                future.wait();
+            }
+        }
+        return future.get();
+    }
+
+    // calls fn(begin, end) over chunks of [0, count) of at least `grain`
+    // items; runs inline below 2 * grain so small inputs stay on the caller
+    template <typename Fn> void parallelFor(std::size_t count, std::size_t grain, Fn&& fn) {
+        grain = std::max<std::size_t>(1, grain);
+        if (count < 2 * grain || this->size() < 2) {
+            if (count > 0) fn(std::size_t{0}, count);
+            return;
+        }
+        // a few chunks per worker keeps them busy when chunks are uneven
+        const std::size_t chunks = std::min(count / grain, this->size() * 4);
+        std::vector<std::future<void>> futures;
+        futures.reserve(chunks);
+        for (std::size_t c = 1; c < chunks; c++) {
+            const std::size_t begin = c * count / chunks;
+            const std::size_t end = (c + 1) * count / chunks;
+            futures.push_back(this->submit([&fn, begin, end]() { fn(begin, end); }));
+        }
+        // every chunk is waited for before an exception leaves, they use fn
+        std::exception_ptr error;
+        try {
+            fn(std::size_t{0}, count / chunks);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (auto& future : futures) {
+            try {
+                this->wait(future);
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    // runs one queued task on the calling thread, false if none was queued
+    bool runPendingTask();
+
+    std::size_t size() const;
+    std::size_t pending() const;
+
+    // process wide pool, sized from the hardware concurrency unless
+    // configureShared() was called before its first use
+    static ThreadPool& shared();
+    // size (0 = default) and worker cpus of shared(); false once it exists
+    static bool configureShared(std::size_t threads, std::vector<int> cpus = {});
+
+  private:
+    void workerLoop(std::vector<int> cpus);
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
+
+} // namespace cc::utils
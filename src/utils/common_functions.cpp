@@ -6,6 +6,14 @@ bool isBarCodeDigit(std::string_view s) {
                            s, [](unsigned char c) { return std::isdigit(c); });
 }
 
+std::vector<std::string> split(std::string_view s, char sep) {
+  std::vector<std::string> parts;
+  for (auto part : s | std::views::split(sep)) {
+    if (!part.empty()) parts.emplace_back(part.begin(), part.end());
+  }
+  return parts;
+}
+
 std::string expand_user_path(const std::string &path) {
   if (!path.starts_with("~/"))
     return path;
@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <cstdint>
 #include <thread>
@@ -22,6 +23,8 @@
 
 namespace cc::utils {
 bool isBarCodeDigit(std::string_view s);
+// split on sep, empty parts are dropped
+std::vector<std::string> split(std::string_view s, char sep);
 std::string expand_user_path(const std::string &path);
 std::string default_food_db_path();
 std::string default_meals_db_path();
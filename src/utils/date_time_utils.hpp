@@ -1,9 +1,12 @@
 #pragma once
 #include "nlohmann/json.hpp"
+#include "utils/Result.hpp"
 #include <chrono>
+#include <cstdlib>
 #include <format>
 #include <sstream>
 #include <string>
+#include <utility>
 
 namespace cc::utils {
 
@@ -28,4 +31,34 @@ inline TimePoint fromIso8601(const std::string& iso) {
     auto t = timegm(&tm); // POSIX: convert UTC struct tm → time_t
     return std::chrono::system_clock::from_time_t(t);
 }
+
+// Parses an inclusive "YYYY-MM-DD" day range, as used by the range endpoints
+inline Result<std::pair<std::chrono::sys_days, std::chrono::sys_days>>
+parseDayRange(const std::string& from, const std::string& to) {
+    using DayRange = std::pair<std::chrono::sys_days, std::chrono::sys_days>;
+    auto validYmd = [](const std::string& s) {
+        return s.size() == 10 && s[4] == '-' && s[7] == '-';
+    };
+    if (!validYmd(from) || !validYmd(to)) {
+        return Result<DayRange>::fail(ErrorCode::InvalidInput,
+                                      "wrong date format (use YYYY-MM-DD)");
+    }
+    auto toYmd = [](const std::string& s) {
+        return std::chrono::year_month_day{
+            std::chrono::year{std::atoi(s.substr(0, 4).c_str())},
+            std::chrono::month{static_cast<unsigned>(std::atoi(s.substr(5, 2).c_str()))},
+            std::chrono::day{static_cast<unsigned>(std::atoi(s.substr(8, 2).c_str()))}};
+    };
+    const auto fromYmd = toYmd(from);
+    const auto toYmdValue = toYmd(to);
+    if (!fromYmd.ok() || !toYmdValue.ok()) {
+        return Result<DayRange>::fail(ErrorCode::InvalidInput, "invalid date values");
+    }
+    const std::chrono::sys_days fromDay{fromYmd};
+    const std::chrono::sys_days toDay{toYmdValue};
+    if (fromDay > toDay) {
+        return Result<DayRange>::fail(ErrorCode::InvalidInput, "invalid range: from > to");
+    }
+    return Result<DayRange>::ok(DayRange{fromDay, toDay});
+}
 } // namespace cc::utils
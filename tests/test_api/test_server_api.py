@@ -18,6 +18,33 @@ def test_health_ok():
     assert j["status"] == "ok"
 
 
+def test_request_id_is_echoed_or_generated():
+    r = requests.get(f"{HOST}/health", headers={"X-Request-Id": "abc-123"}, timeout=1)
+    assert r.headers["X-Request-Id"] == "abc-123"
+    r = requests.get(f"{HOST}/health", headers={"X-Request-Id": "bad id"}, timeout=1)
+    assert len(r.headers["X-Request-Id"]) == 16
+    assert "total;dur=" in r.headers["Server-Timing"]
+
+
+def test_server_timing_reports_phases():
+    r = requests.get(f"{HOST}/meals", timeout=2)
+    assert r.status_code == 200
+    timing = r.headers["Server-Timing"]
+    assert "storage;dur=" in timing
+    assert "serialize;dur=" in timing
+
+
+def test_metrics_in_prometheus_format():
+    requests.get(f"{HOST}/health", timeout=1)
+    r = requests.get(f"{HOST}/metrics", timeout=2)
+    assert r.status_code == 200
+    assert r.headers["Content-Type"].startswith("text/plain")
+    assert "# TYPE cc_http_requests_total counter" in r.text
+    assert 'cc_http_requests_total{method="GET",path="/health",status="200"}' in r.text
+    assert "cc_http_request_duration_seconds_bucket{" in r.text
+    assert "cc_food_cache_entries " in r.text
+
+
 # ---------- Helpers ----------
 
 def clear_meals_db():
@@ -182,6 +209,14 @@ def test_delete_food_then_search_should_not_find_or_should_error():
 
 # ---------- Meals Tests ----------
 
+def test_post_by_barcodes_rejects_invalid_lists():
+    for body in ({"barcodes": []}, {"barcodes": [7]}, {"barcodes": "007"},
+                 {"barcodes": ["007", None]}):
+        r = requests.post(f"{HOST}/foods/by_barcodes", json=body, timeout=2)
+        assert r.status_code == 400
+        assert "error" in r.json()
+
+
 def test_meals_list():
     # keep deterministic
     clear_meals_db()
@@ -395,3 +430,80 @@ def test_stats_day_returns_summary():
     assert j["mealsCount"] == 2
     assert "totalCalories" in j
     assert j["totalCalories"] != 0 
+
+
+def test_batch_runs_operations_in_order():
+    clear_meals_db()
+    clear_foods_db()
+
+    ops = [
+        {"method": "GET", "path": "/stats/day?day=2&month=2&year=2026"},
+        {"method": "POST", "path": "/foods",
+         "body": {"id": "007", "name": "Oats", "caloriePer100g": 400.0}},
+        {"method": "POST", "path": "/meals",
+         "body": {"name": "Lunch", "tsUtc": "2026-02-02T13:05:00Z",
+                  "foodItems": [{"foodId": "007", "grams": 50}]}},
+        {"method": "POST", "path": "/meals", "body": {"name": "Brunch"}},
+        {"method": "GET", "path": "/stats/day?day=2&month=2&year=2026"},
+        {"method": "GET", "path": "/foods/by_barcode?barcode=007"},
+    ]
+    r = requests.post(f"{HOST}/batch", json=ops, timeout=5)
+    assert r.status_code == 200
+    results = r.json()
+    assert [res["status"] for res in results] == [200, 200, 200, 400, 200, 200]
+    # a read sees the writes placed before it, not the ones after
+    assert results[0]["body"]["mealsCount"] == 0
+    assert results[4]["body"]["mealsCount"] == 1
+    assert results[4]["body"]["totalCalories"] == 200
+    assert results[5]["body"]["name"] == "Oats"
+
+
+def test_batch_post_food_keeps_order_and_existing_foods():
+    clear_foods_db()
+    food = {"id": "007", "name": "Oats", "caloriePer100g": 400.0}
+    assert requests.post(f"{HOST}/foods", json=food, timeout=2).status_code == 200
+
+    ops = [
+        # like POST /foods, an existing id is not overwritten
+        {"method": "POST", "path": "/foods",
+         "body": {"id": "007", "name": "Rice", "caloriePer100g": 130.0}},
+        {"method": "DELETE", "path": "/foods?barcode=008"},
+        {"method": "POST", "path": "/foods",
+         "body": {"id": "008", "name": "Milk", "caloriePer100g": 60.0}},
+    ]
+    r = requests.post(f"{HOST}/batch", json=ops, timeout=5)
+    assert r.status_code == 200
+    r = requests.get(f"{HOST}/foods/by_barcode", params={"barcode": "007"}, timeout=2)
+    assert r.json()["name"] == "Oats"
+    # the delete ran before the post that follows it
+    r = requests.get(f"{HOST}/foods/by_barcode", params={"barcode": "008"}, timeout=2)
+    assert r.status_code == 200
+    assert r.json()["name"] == "Milk"
+
+
+def test_batch_rejects_non_array_body():
+    r = requests.post(f"{HOST}/batch", json={"method": "GET"}, timeout=2)
+    assert r.status_code == 400
+
+
+def test_by_range_is_rate_limited_per_client():
+    params = {"from": "2026-02-01", "to": "2026-02-02"}
+    codes = []
+    for _ in range(30):
+        r = requests.get(f"{HOST}/meals/by_range", params=params, timeout=2)
+        codes.append(r.status_code)
+        if r.status_code == 429:
+            assert int(r.headers["Retry-After"]) >= 1
+            break
+    assert 429 in codes
+    # other routes are not affected
+    assert requests.get(f"{HOST}/health", timeout=1).status_code == 200
+
+
+def test_batch_operations_count_against_route_limits():
+    ops = [{"method": "GET",
+            "path": "/meals/by_range?from=2026-02-01&to=2026-02-02"}] * 30
+    r = requests.post(f"{HOST}/batch", json=ops, timeout=10)
+    assert r.status_code == 200
+    statuses = [res["status"] for res in r.json()]
+    assert 429 in statuses or 503 in statuses
@@ -73,6 +73,27 @@ TEST_F(FoodModelTest, setNutrients) {
     EXPECT_EQ(food.nutrients()[0].type(), NutrientType::Protein);
     EXPECT_EQ(food.nutrients()[1].type(), NutrientType::Carbs);
 }
+TEST_F(FoodModelTest, nutrients_are_indexed_by_type_in_canonical_units) {
+    food.setNutrients({Nutrient{NutrientType::Fat, 1500, "mg"}, Nutrient{NutrientType::Protein, 24, "g"},
+                       Nutrient{NutrientType::Protein, 1, "g"}});
+    EXPECT_DOUBLE_EQ(food.nutrient(NutrientType::Fat), 1.5);
+    EXPECT_DOUBLE_EQ(food.nutrient(NutrientType::Protein), 25);
+    EXPECT_TRUE(food.hasNutrient(NutrientType::Protein));
+    EXPECT_FALSE(food.hasNutrient(NutrientType::Carbs));
+    EXPECT_EQ(food.nutrient(NutrientType::Carbs), 0);
+    // listed in NutrientType order, whatever the input order was
+    ASSERT_EQ(food.nutrients().size(), 2u);
+    EXPECT_EQ(food.nutrients()[0].type(), NutrientType::Protein);
+    EXPECT_EQ(food.nutrients()[1].type(), NutrientType::Fat);
+    EXPECT_EQ(food.nutrients()[1].unit(), "g");
+
+    food.setNutrient(NutrientType::Carbs, 250, "mg");
+    EXPECT_DOUBLE_EQ(food.nutrient(NutrientType::Carbs), 0.25);
+    nlohmann::json food_json = food;
+    ASSERT_EQ(food_json["nutrient"].size(), 3u);
+    Food copy = food_json;
+    EXPECT_EQ(copy.nutrientValues(), food.nutrientValues());
+}
 TEST_F(FoodModelTest, setSource) {
     Food food;
     food.setSource(SOURCE::Manual);
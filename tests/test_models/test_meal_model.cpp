@@ -132,3 +132,20 @@ TEST_F(MealModelTest, to_Json) {
     EXPECT_EQ(meal_json["foodItems"][0][1].get<double>(), meal.food_items()[0].second);
     EXPECT_EQ(meal_json["tsUtc"].get<std::string>(), cc::utils::toIso8601(meal.gettime()));
 }
+
+TEST_F(MealModelTest, nutrition_round_trips_and_is_dropped_when_items_change) {
+    meal.setFoodItems({{"002", 100}});
+    NutritionTotals totals{250.0, 10.0, 30.0, 5.0};
+    meal.setNutrition(totals);
+    nlohmann::json meal_json = meal;
+    EXPECT_EQ(meal_json["calories"].get<double>(), 250.0);
+    EXPECT_EQ(meal_json["Protein"].get<double>(), 10.0);
+    MealLog copy = meal_json;
+    ASSERT_TRUE(copy.nutrition().has_value());
+    EXPECT_EQ(*copy.nutrition(), totals);
+
+    copy.addFoodItem("009", 50);
+    EXPECT_FALSE(copy.nutrition().has_value());
+    nlohmann::json without = copy;
+    EXPECT_FALSE(without.contains("calories"));
+}
@@ -0,0 +1,101 @@
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "models/nutrition_table.hpp"
+#include <array>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace cc::models;
+
+class NutritionTableTest : public ::testing::Test {
+protected:
+    void SetUp() override { // runs BEFORE each TEST_F
+    }
+
+    void TearDown() override { // runs AFTER each TEST_F
+                               // nothing to destroy //
+    }
+
+    static Food makeFood(const std::string& id, double kcal, double protein, double carbs,
+                         double fat) {
+        Food food;
+        food.setId(id);
+        food.setBarcode(id);
+        food.setName(id);
+        food.setCaloriesPer100g(kcal);
+        food.setNutrients({{NutrientType::Protein, protein, "g"},
+                           {NutrientType::Carbs, carbs, "g"},
+                           {NutrientType::Fat, fat, "g"}});
+        return food;
+    }
+};
+
+TEST_F(NutritionTableTest, kernels_agree_with_the_food_objects) {
+    std::vector<double> kcal;
+    std::array<std::vector<double>, NUTRIENTS.size()> values;
+    std::vector<Food> foods;
+    for (int i = 0; i < 37; i++) {
+        foods.push_back(makeFood(std::to_string(i), 50 + i * 11, i * 0.7, 80 - i, i % 5 * 1.3));
+        foods.back().setNutrient(NutrientType::Sodium, i * 13.0, "mg");
+        kcal.push_back(foods.back().caloriesPer100g());
+        for (const auto& info : NUTRIENTS) {
+            values[nutrientIndex(info.type)].push_back(foods.back().nutrient(info.type));
+        }
+    }
+    NutritionColumns columns{kcal.data(), {}};
+    for (std::size_t i = 0; i < values.size(); i++) {
+        columns.nutrients[i] = values[i].data();
+    }
+    std::vector<std::uint32_t> slots;
+    std::vector<double> grams;
+    NutritionTotals expected;
+    // odd count so every kernel runs its scalar tail
+    for (std::uint32_t i = 0; i < 103; i++) {
+        slots.push_back(i * 7 % 37);
+        grams.push_back(5.0 + i % 13 * 12.5);
+        expected.add(foods[slots.back()], grams.back());
+    }
+
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    if (detectSimdLevel() != SimdLevel::Scalar) levels.push_back(SimdLevel::SSE2);
+    if (detectSimdLevel() == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+    for (SimdLevel level : levels) {
+        NutritionTotals t =
+            accumulateNutrition(columns, slots.data(), grams.data(), slots.size(), level);
+        EXPECT_NEAR(t.calories, expected.calories, 1e-6) << static_cast<int>(level);
+        for (const auto& info : NUTRIENTS) {
+            EXPECT_NEAR(t[info.type], expected[info.type], 1e-6)
+                << static_cast<int>(level) << " " << info.offKey;
+        }
+    }
+}
+
+TEST_F(NutritionTableTest, upsert_erase_and_stale_loads) {
+    NutritionTable table;
+    table.upsert("oats", makeFood("oats", 400, 10, 60, 8));
+    table.upsert("milk", makeFood("milk", 50, 3, 5, 1));
+    auto totals = table.totals({{"oats", 50}, {"milk", 200}});
+    ASSERT_TRUE(totals.has_value());
+    EXPECT_DOUBLE_EQ(totals->calories, 300);
+    EXPECT_DOUBLE_EQ((*totals)[NutrientType::Protein], 11);
+
+    EXPECT_FALSE(table.totals({{"oats", 50}, {"rice", 10}}).has_value());
+    EXPECT_EQ(table.missing({{"oats", 50}, {"rice", 10}}), std::vector<std::string>{"rice"});
+
+    // a value loaded before the erase must not come back
+    auto epoch = table.epoch();
+    table.erase("oats");
+    table.upsert("oats", makeFood("oats", 400, 10, 60, 8), epoch);
+    EXPECT_FALSE(table.totals({{"oats", 50}}).has_value());
+
+    // the freed slot is reused
+    table.upsert("rice", makeFood("rice", 130, 2, 28, 0), table.epoch());
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_DOUBLE_EQ(table.totals({{"rice", 100}})->calories, 130);
+
+    table.clear();
+    EXPECT_EQ(table.size(), 0);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "clients/OpenFoodFactsClient.hpp"
+#include "models/food.hpp"
+#include "utils/Result.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// stands in for OpenFoodFacts in service tests: answers every numeric
+// barcode after a delay and counts how often it was asked
+class FakeOffClient : public cc::clients::OpenFoodFactsClient {
+public:
+  explicit FakeOffClient(std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+      : delay_{delay} {}
+
+  cc::utils::Result<cc::models::Food>
+  getByBarcode(const std::string &barcode) override {
+    calls++;
+    std::this_thread::sleep_for(delay_);
+    if (barcode.empty() || barcode.find_first_not_of("0123456789") != std::string::npos) {
+      return cc::utils::Result<cc::models::Food>::fail(
+          cc::utils::ErrorCode::InvalidInput, "barcode needs to be a number");
+    }
+    cc::models::Food food;
+    food.setId(barcode);
+    food.setBarcode(barcode);
+    food.setName("fake");
+    food.setBrand("fake");
+    food.setCaloriesPer100g(100);
+    food.setNutrients({{cc::models::NutrientType::Protein, 10, "g"},
+                       {cc::models::NutrientType::Carbs, 20, "g"},
+                       {cc::models::NutrientType::Fat, 5, "g"}});
+    return cc::utils::Result<cc::models::Food>::ok(food);
+  }
+
+  std::atomic<int> calls{0};
+
+private:
+  std::chrono::milliseconds delay_;
+};
@@ -0,0 +1,234 @@
+#include "fake_off_client.hpp"
+#include "models/meal_log.hpp"
+#include "services/DailyAggregateStore.hpp"
+#include "services/FoodService.hpp"
+#include "services/MealService.hpp"
+#include "storage/JsonFoodRepository.hpp"
+#include "storage/JsonMealRepository.hpp"
+#include "utils/date_time_utils.hpp"
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+using namespace cc::services;
+
+class DailyAggregateStoreTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+    food_repo = std::make_shared<cc::storage::JsonFoodRepository>(path_to_food_temp_db);
+    meal_repo = std::make_shared<cc::storage::JsonMealRepository>(path_to_meal_temp_db);
+    food_service = std::make_shared<FoodService>(food_repo, std::make_shared<FakeOffClient>());
+    food_service->clear_data_base();
+    meal_repo->clear();
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+    std::remove(path_to_food_temp_db.c_str());
+    std::remove(path_to_meal_temp_db.c_str());
+  }
+
+  static cc::models::MealLog mealAt(const std::string &tsUtc, double kcal) {
+    cc::models::MealLog meal;
+    meal.setTime(cc::utils::fromIso8601(tsUtc));
+    meal.setNutrition(cc::models::NutritionTotals{kcal, {1, 2, 3}});
+    return meal;
+  }
+
+  std::string path_to_food_temp_db{"/tmp/cc_UT_test_aggregates_food_db.json"};
+  std::string path_to_meal_temp_db{"/tmp/cc_UT_test_aggregates_meal_db.json"};
+  std::shared_ptr<cc::storage::JsonFoodRepository> food_repo;
+  std::shared_ptr<cc::storage::JsonMealRepository> meal_repo;
+  std::shared_ptr<FoodService> food_service;
+};
+
+TEST_F(DailyAggregateStoreTest, add_and_remove_update_the_meal_day) {
+  using namespace std::chrono;
+  DailyAggregateStore store;
+  auto breakfast = mealAt("2026-02-02T08:00:00Z", 300);
+  auto dinner = mealAt("2026-02-02T23:59:59Z", 700);
+  auto next_day = mealAt("2026-02-03T00:00:00Z", 100);
+  cc::models::MealLog pending;
+  pending.setTime(cc::utils::fromIso8601("2026-02-02T12:00:00Z"));
+  store.add(breakfast);
+  store.add(dinner);
+  store.add(next_day);
+  store.add(pending);
+
+  const sys_days feb2{year{2026} / February / day{2}};
+  DailyTotals totals = store.get(feb2);
+  EXPECT_EQ(totals.mealsCount, 3);
+  EXPECT_EQ(totals.pendingMeals, 1);
+  EXPECT_DOUBLE_EQ(totals.totals.calories, 1000);
+  EXPECT_DOUBLE_EQ(totals.totals[cc::models::NutrientType::Fat], 6);
+  EXPECT_EQ(store.get(feb2 + days{1}).mealsCount, 1);
+
+  store.remove(dinner);
+  store.remove(pending);
+  EXPECT_DOUBLE_EQ(store.get(feb2).totals.calories, 300);
+  EXPECT_EQ(store.get(feb2).pendingMeals, 0);
+  store.remove(breakfast);
+  EXPECT_EQ(store.get(feb2).mealsCount, 0);
+  EXPECT_EQ(store.days(), 1);
+}
+
+TEST_F(DailyAggregateStoreTest, day_versions_change_with_the_totals) {
+  using namespace std::chrono;
+  DailyAggregateStore store;
+  const sys_days feb2{year{2026} / February / day{2}};
+  const auto before = store.dayVersion(feb2);
+  const auto other_day = store.dayVersion(feb2 + days{1});
+
+  store.add(mealAt("2026-02-02T08:00:00Z", 300));
+  std::uint64_t version = 0;
+  EXPECT_DOUBLE_EQ(store.get(feb2, &version).totals.calories, 300);
+  EXPECT_GT(version, before);
+  EXPECT_EQ(version, store.dayVersion(feb2));
+  EXPECT_EQ(store.dayVersion(feb2 + days{1}), other_day);
+
+  store.clear();
+  EXPECT_GT(store.dayVersion(feb2 + days{1}), version);
+}
+
+TEST_F(DailyAggregateStoreTest, meal_service_keeps_day_totals_in_sync) {
+  cc::models::Food oats;
+  oats.setId("0101");
+  oats.setBarcode("0101");
+  oats.setName("oats");
+  oats.setBrand("brand");
+  oats.setCaloriesPer100g(400);
+  food_service->addManualFood(oats);
+
+  MealService meal_service{meal_repo};
+  meal_service.setFoodService(food_service);
+  cc::models::MealLog breakfast;
+  breakfast.setTime(cc::utils::fromIso8601("2026-02-02T08:00:00Z"));
+  breakfast.setFoodItems({{"0101", 50}});
+  meal_service.addNewMeal(breakfast);
+  cc::models::MealLog lunch;
+  lunch.setTime(cc::utils::fromIso8601("2026-02-02T13:00:00Z"));
+  lunch.setFoodItems({{"0101", 100}});
+  meal_service.addNewMeal(lunch);
+
+  auto totals = meal_service.dailyTotals(2, 2, 2026).unwrap();
+  EXPECT_EQ(totals.mealsCount, 2);
+  EXPECT_DOUBLE_EQ(totals.totals.calories, 600);
+
+  // moved to the next day with a different amount
+  lunch.setTime(cc::utils::fromIso8601("2026-02-03T13:00:00Z"));
+  lunch.setFoodItems({{"0101", 25}});
+  meal_service.updateMeal(lunch);
+  EXPECT_DOUBLE_EQ(meal_service.dailyTotals(2, 2, 2026).unwrap().totals.calories, 200);
+  EXPECT_DOUBLE_EQ(meal_service.dailyTotals(3, 2, 2026).unwrap().totals.calories, 100);
+
+  oats.setCaloriesPer100g(200);
+  food_service->updateFood(oats);
+  EXPECT_DOUBLE_EQ(meal_service.dailyTotals(2, 2, 2026).unwrap().totals.calories, 100);
+
+  meal_service.deleteMeal(breakfast.id());
+  EXPECT_EQ(meal_service.dailyTotals(2, 2, 2026).unwrap().mealsCount, 0);
+
+  // a new service rebuilds the aggregates from the repository
+  MealService restarted{meal_repo};
+  EXPECT_DOUBLE_EQ(restarted.dailyTotals(3, 2, 2026).unwrap().totals.calories, 50);
+  EXPECT_FALSE(restarted.dailyTotals(30, 2, 2026));
+
+  meal_service.clear_data_base();
+  EXPECT_EQ(meal_service.dailyTotals(3, 2, 2026).unwrap().mealsCount, 0);
+}
+
+TEST_F(DailyAggregateStoreTest, range_sums_and_periods) {
+  using namespace std::chrono;
+  DailyAggregateStore store;
+  // far apart days make the tree grow in both directions
+  store.add(mealAt("2026-02-02T08:00:00Z", 100)); // Monday
+  store.add(mealAt("2026-02-08T08:00:00Z", 200)); // Sunday
+  store.add(mealAt("2026-02-09T08:00:00Z", 400)); // next Monday
+  store.add(mealAt("2026-03-01T08:00:00Z", 800));
+  store.add(mealAt("2025-01-01T08:00:00Z", 1600));
+  store.add(mealAt("2027-12-31T08:00:00Z", 3200));
+
+  const sys_days feb1{year{2026} / February / day{1}};
+  const sys_days mar31{year{2026} / March / day{31}};
+  EXPECT_DOUBLE_EQ(store.sum(feb1, mar31).totals.calories, 1500);
+  EXPECT_EQ(store.sum(feb1, mar31).mealsCount, 4);
+  EXPECT_DOUBLE_EQ(store.sum(sys_days{year{2000} / 1 / 1}, sys_days{year{2030} / 1 / 1})
+                       .totals.calories,
+                   6300);
+
+  auto weeks = store.periods(feb1, mar31, Granularity::Week);
+  // Sunday Feb 1 alone, then full weeks starting on Mondays
+  ASSERT_GE(weeks.size(), 3);
+  EXPECT_EQ(weeks[0].start, feb1);
+  EXPECT_EQ(weeks[0].end, feb1);
+  EXPECT_DOUBLE_EQ(weeks[1].totals.totals.calories, 300);
+  EXPECT_DOUBLE_EQ(weeks[2].totals.totals.calories, 400);
+  EXPECT_EQ(weeks.back().end, mar31);
+
+  auto months = store.periods(feb1 + days{5}, mar31, Granularity::Month);
+  ASSERT_EQ(months.size(), 2);
+  EXPECT_EQ(months[0].end, sys_days{year{2026} / February / day{28}});
+  EXPECT_DOUBLE_EQ(months[0].totals.totals.calories, 600);
+  EXPECT_DOUBLE_EQ(months[1].totals.totals.calories, 800);
+
+  EXPECT_EQ(store.periods(feb1, feb1 + days{2}, Granularity::Day).size(), 3);
+
+  for (auto g : {Granularity::Day, Granularity::Week, Granularity::Month}) {
+    EXPECT_EQ(DailyAggregateStore::periodCount(feb1, mar31, g),
+              store.periods(feb1, mar31, g).size());
+  }
+  EXPECT_EQ(DailyAggregateStore::periodCount(sys_days{year{1} / 1 / 1},
+                                             sys_days{year{9999} / 12 / 31},
+                                             Granularity::Month),
+            9999 * 12);
+}
+
+TEST_F(DailyAggregateStoreTest, days_far_from_the_others_are_still_summed) {
+  using namespace std::chrono;
+  DailyAggregateStore store;
+  // outside the days the tree covers, kept aside instead of growing it
+  store.add(mealAt("1700-01-01T08:00:00Z", 1));
+  store.add(mealAt("2026-02-02T08:00:00Z", 10));
+  store.add(mealAt("2250-12-31T08:00:00Z", 100));
+
+  const sys_days first{year{1700} / 1 / 1};
+  const sys_days last{year{2250} / 12 / 31};
+  EXPECT_DOUBLE_EQ(store.get(first).totals.calories, 1);
+  EXPECT_DOUBLE_EQ(store.sum(first, last).totals.calories, 111);
+  EXPECT_DOUBLE_EQ(store.sum(first + days{1}, last).totals.calories, 110);
+  EXPECT_DOUBLE_EQ(store.sum(first, last - days{1}).totals.calories, 11);
+  EXPECT_EQ(store.sum(first, last).mealsCount, 3);
+
+  store.remove(mealAt("2250-12-31T08:00:00Z", 100));
+  EXPECT_DOUBLE_EQ(store.sum(first, last).totals.calories, 11);
+  EXPECT_EQ(store.days(), 2);
+}
+
+TEST_F(DailyAggregateStoreTest, series_is_downsampled_to_the_requested_points) {
+  using namespace std::chrono;
+  DailyAggregateStore store;
+  store.add(mealAt("2026-01-01T08:00:00Z", 1000));
+  store.add(mealAt("2026-01-02T08:00:00Z", 3000));
+  store.add(mealAt("2026-12-31T08:00:00Z", 500));
+
+  const sys_days jan1{year{2026} / January / day{1}};
+  const sys_days dec31{year{2026} / December / day{31}};
+  auto points = store.series(jan1, dec31, 12);
+  ASSERT_EQ(points.size(), 12);
+  EXPECT_EQ(points.front().start, jan1);
+  EXPECT_EQ(points.back().end, dec31);
+  for (std::size_t i = 1; i < points.size(); i++) {
+    EXPECT_EQ(points[i].start, points[i - 1].end + days{1});
+  }
+  EXPECT_DOUBLE_EQ(points.front().totals.totals.calories, 4000);
+  EXPECT_DOUBLE_EQ(points.front().maxCalories, 3000);
+  EXPECT_DOUBLE_EQ(points.front().minCalories, 0);
+  EXPECT_DOUBLE_EQ(points[5].maxCalories, 0);
+  EXPECT_DOUBLE_EQ(points.back().totals.totals.calories, 500);
+
+  // never more points than days
+  auto two_days = store.series(jan1, jan1 + days{1}, 100);
+  ASSERT_EQ(two_days.size(), 2);
+  EXPECT_DOUBLE_EQ(two_days[1].minCalories, 3000);
+}
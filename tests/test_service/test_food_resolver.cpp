@@ -0,0 +1,77 @@
+#include "fake_off_client.hpp"
+#include "models/meal_log.hpp"
+#include "services/FoodResolver.hpp"
+#include "services/FoodService.hpp"
+#include "services/MealService.hpp"
+#include "storage/JsonFoodRepository.hpp"
+#include "storage/JsonMealRepository.hpp"
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cc::services;
+
+class FoodResolverTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+    food_repo = std::make_shared<cc::storage::JsonFoodRepository>(path_to_food_temp_db);
+    meal_repo = std::make_shared<cc::storage::JsonMealRepository>(path_to_meal_temp_db);
+    food_service = std::make_shared<FoodService>(food_repo, client);
+    food_service->clear_data_base();
+    meal_repo->clear();
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+    std::remove(path_to_food_temp_db.c_str());
+    std::remove(path_to_meal_temp_db.c_str());
+  }
+  std::string path_to_food_temp_db{"/tmp/cc_UT_test_resolver_food_db.json"};
+  std::string path_to_meal_temp_db{"/tmp/cc_UT_test_resolver_meal_db.json"};
+  std::shared_ptr<FakeOffClient> client =
+      std::make_shared<FakeOffClient>(std::chrono::milliseconds(20));
+  std::shared_ptr<cc::storage::JsonFoodRepository> food_repo;
+  std::shared_ptr<cc::storage::JsonMealRepository> meal_repo;
+  std::shared_ptr<FoodService> food_service;
+};
+
+TEST_F(FoodResolverTest, added_meal_food_items_are_saved_in_background) {
+  auto resolver = std::make_shared<FoodResolver>(food_service);
+  MealService meal_service{meal_repo};
+  meal_service.setFoodResolver(resolver);
+
+  cc::models::MealLog lunch;
+  lunch.setFoodItems({{"1111", 50}, {"2222", 100}});
+  ASSERT_TRUE(meal_service.addNewMeal(lunch));
+
+  resolver->waitIdle();
+  EXPECT_EQ(food_repo->list().unwrap().size(), 2);
+  auto stats = resolver->stats();
+  EXPECT_EQ(stats.queueDepth, 0);
+  EXPECT_EQ(stats.resolved, 2);
+  EXPECT_EQ(stats.failed, 0);
+
+  // already saved, so reading them again does not go online
+  int calls_before = client->calls;
+  EXPECT_TRUE(food_service->getOrFetchByBarcode("1111"));
+  EXPECT_EQ(client->calls, calls_before);
+}
+
+TEST_F(FoodResolverTest, duplicate_ids_are_queued_once_and_failures_counted) {
+  FoodResolver resolver{food_service};
+  resolver.enqueue({"3333", "3333", "not-a-barcode"});
+  resolver.waitIdle();
+  auto stats = resolver.stats();
+  EXPECT_EQ(stats.resolved + stats.failed, 2);
+  EXPECT_EQ(stats.failed, 1);
+  EXPECT_EQ(food_repo->list().unwrap().size(), 1);
+}
+
+TEST_F(FoodResolverTest, enqueue_after_stop_is_ignored) {
+  FoodResolver resolver{food_service};
+  resolver.stop();
+  resolver.enqueue({"4444"});
+  EXPECT_EQ(resolver.stats().queueDepth, 0);
+}
@@ -1,4 +1,5 @@
 #include "clients/OpenFoodFactsClient.hpp"
+#include "fake_off_client.hpp"
 #include "models/food.hpp"
 #include "models/nutrient.hpp"
 #include "services/FoodService.hpp"
@@ -8,11 +9,15 @@
 #include <gtest/gtest.h>
 #include <magic_enum.hpp>
 #include <memory>
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace cc::services;
 
+
 class FoodServiceTest : public ::testing::Test {
 protected:
   void SetUp() override { // runs BEFORE each TEST_F
@@ -232,3 +237,97 @@ TEST_F(FoodServiceTest, getOrFetchByBarcode_wrong_id) {
       food_service.getOrFetchByBarcode(wrong_barcode);
   EXPECT_EQ(food.unwrap_error().code, cc::utils::ErrorCode::NotFound);
 }
+
+TEST_F(FoodServiceTest, getOrFetchByBarcode_concurrent_callers_share_one_fetch) {
+  std::shared_ptr<cc::storage::JsonFoodRepository> repo_shared_ptr =
+      std::make_shared<cc::storage::JsonFoodRepository>(path_to_temp_db);
+  auto client_ptr =
+      std::make_shared<FakeOffClient>(std::chrono::milliseconds(200));
+  FoodService food_service{repo_shared_ptr, client_ptr};
+  food_service.clear_data_base();
+
+  std::string barcode("4250519647425");
+  std::vector<std::thread> workers;
+  std::atomic<int> found{0};
+  for (int i = 0; i < 8; i++) {
+    workers.emplace_back([&]() {
+      if (food_service.getOrFetchByBarcode(barcode)) {
+        found++;
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  EXPECT_EQ(found, 8);
+  EXPECT_EQ(client_ptr->calls, 1);
+  EXPECT_EQ(food_service.listFoods().unwrap().size(), 1);
+  std::remove(path_to_temp_db.c_str());
+}
+
+TEST_F(FoodServiceTest, getOrFetchMany_mixes_local_hits_and_fetched_misses) {
+  std::shared_ptr<cc::storage::JsonFoodRepository> repo_shared_ptr =
+      std::make_shared<cc::storage::JsonFoodRepository>(path_to_temp_db);
+  auto client_ptr =
+      std::make_shared<FakeOffClient>(std::chrono::milliseconds(100));
+  FoodService food_service{repo_shared_ptr, client_ptr};
+  food_service.clear_data_base();
+  cc::models::Food food;
+  food.setId("0707070");
+  food.setName("minina");
+  food.setBrand("Aicha");
+  food.setBarcode("0707070");
+  food_service.addManualFood(food);
+
+  std::vector<std::string> barcodes{"111", "0707070", "222", "111", "oops"};
+  auto start = std::chrono::steady_clock::now();
+  auto results = food_service.getOrFetchMany(barcodes);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_EQ(results.size(), barcodes.size());
+  EXPECT_EQ(results[0].unwrap().id(), "111");
+  EXPECT_EQ(results[1].unwrap().name(), "minina");
+  EXPECT_EQ(results[2].unwrap().id(), "222");
+  EXPECT_EQ(results[3].unwrap().id(), "111");
+  EXPECT_EQ(results[4].unwrap_error().code, cc::utils::ErrorCode::InvalidInput);
+  // the local hit is not fetched, the duplicate miss is fetched once
+  EXPECT_EQ(client_ptr->calls, 3);
+  // misses are fetched concurrently, not one after the other
+  EXPECT_LT(elapsed, std::chrono::milliseconds(300));
+  EXPECT_EQ(food_service.listFoods().unwrap().size(), 3);
+  std::remove(path_to_temp_db.c_str());
+}
+
+TEST_F(FoodServiceTest, cached_food_is_invalidated_on_update_and_delete) {
+  std::shared_ptr<cc::storage::JsonFoodRepository> repo_shared_ptr =
+      std::make_shared<cc::storage::JsonFoodRepository>(path_to_temp_db);
+  auto client_ptr = std::make_shared<FakeOffClient>();
+  FoodService food_service{repo_shared_ptr, client_ptr};
+  food_service.configureCache(1024 * 1024, cc::utils::CachePolicy::ARC);
+  food_service.clear_data_base();
+  cc::models::Food food;
+  food.setId("0707070");
+  food.setName("minina");
+  food.setBrand("Aicha");
+  food.setBarcode("0707070");
+  food_service.addManualFood(food);
+
+  EXPECT_EQ(food_service.getOrFetchByBarcode("0707070").unwrap().name(), "minina");
+  EXPECT_EQ(food_service.getOrFetchByBarcode("0707070").unwrap().name(), "minina");
+  EXPECT_EQ(food_service.cacheStats().hits, 1);
+  EXPECT_EQ(food_service.cacheStats().entries, 1);
+
+  food.setName("new name");
+  food_service.updateFood(food);
+  EXPECT_EQ(food_service.getOrFetchByBarcode("0707070").unwrap().name(), "new name");
+
+  food_service.deleteFood(food.id());
+  EXPECT_EQ(food_service.cacheStats().entries, 0);
+  // gone locally, so it is looked up online again
+  food_service.getOrFetchByBarcode("0707070");
+  EXPECT_EQ(client_ptr->calls, 1);
+
+  food_service.clear_data_base();
+  EXPECT_EQ(food_service.cacheStats().entries, 0);
+  std::remove(path_to_temp_db.c_str());
+}
@@ -0,0 +1,103 @@
+#include "fake_off_client.hpp"
+#include "models/meal_log.hpp"
+#include "services/FoodService.hpp"
+#include "services/FoodUsageIndex.hpp"
+#include "services/MealService.hpp"
+#include "storage/JsonFoodRepository.hpp"
+#include "storage/JsonMealRepository.hpp"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cc::services;
+
+class FoodUsageIndexTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+    food_repo = std::make_shared<cc::storage::JsonFoodRepository>(path_to_food_temp_db);
+    meal_repo = std::make_shared<cc::storage::JsonMealRepository>(path_to_meal_temp_db);
+    food_service = std::make_shared<FoodService>(food_repo, std::make_shared<FakeOffClient>());
+    food_service->clear_data_base();
+    meal_repo->clear();
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+    std::remove(path_to_food_temp_db.c_str());
+    std::remove(path_to_meal_temp_db.c_str());
+  }
+
+  std::string path_to_food_temp_db{"/tmp/cc_UT_test_usage_food_db.json"};
+  std::string path_to_meal_temp_db{"/tmp/cc_UT_test_usage_meal_db.json"};
+  std::shared_ptr<cc::storage::JsonFoodRepository> food_repo;
+  std::shared_ptr<cc::storage::JsonMealRepository> meal_repo;
+  std::shared_ptr<FoodService> food_service;
+};
+
+TEST_F(FoodUsageIndexTest, index_follows_meal_items) {
+  FoodUsageIndex index;
+  cc::models::MealLog breakfast;
+  breakfast.setFoodItems({{"oats", 50}, {"milk", 200}, {"oats", 10}});
+  cc::models::MealLog lunch;
+  lunch.setFoodItems({{"milk", 100}});
+  index.add(breakfast);
+  index.add(lunch);
+
+  EXPECT_EQ(index.mealsUsing("oats"), std::vector<int>{breakfast.id()});
+  EXPECT_EQ(index.mealsUsing("milk"), (std::vector<int>{breakfast.id(), lunch.id()}));
+  EXPECT_TRUE(index.mealsUsing("rice").empty());
+
+  index.remove(breakfast);
+  EXPECT_TRUE(index.mealsUsing("oats").empty());
+  EXPECT_EQ(index.mealsUsing("milk"), std::vector<int>{lunch.id()});
+  EXPECT_EQ(index.foods(), 1);
+}
+
+TEST_F(FoodUsageIndexTest, meal_service_reports_usage_and_invalidations) {
+  MealService meal_service{meal_repo};
+  meal_service.setFoodService(food_service);
+  std::vector<std::pair<std::string, std::vector<int>>> invalidated;
+  meal_service.addMealsInvalidatedListener(
+      [&](const std::string &foodId, const std::vector<int> &mealIds) {
+        invalidated.emplace_back(foodId, mealIds);
+      });
+
+  cc::models::MealLog breakfast;
+  breakfast.setFoodItems({{"0101", 50}});
+  meal_service.addNewMeal(breakfast);
+  cc::models::MealLog dinner;
+  dinner.setFoodItems({{"0202", 50}});
+  meal_service.addNewMeal(dinner);
+  EXPECT_EQ(meal_service.mealsUsingFood("0101"), std::vector<int>{breakfast.id()});
+
+  dinner.setFoodItems({{"0101", 80}});
+  meal_service.updateMeal(dinner);
+  EXPECT_EQ(meal_service.mealsUsingFood("0101"),
+            (std::vector<int>{breakfast.id(), dinner.id()}));
+  EXPECT_TRUE(meal_service.mealsUsingFood("0202").empty());
+
+  cc::models::Food oats;
+  oats.setId("0101");
+  oats.setBarcode("0101");
+  oats.setName("oats");
+  oats.setBrand("brand");
+  oats.setCaloriesPer100g(400);
+  food_service->addManualFood(oats);
+  ASSERT_EQ(invalidated.size(), 1);
+  EXPECT_EQ(invalidated[0].first, "0101");
+  EXPECT_EQ(invalidated[0].second, (std::vector<int>{breakfast.id(), dinner.id()}));
+  EXPECT_DOUBLE_EQ(meal_service.getById(dinner.id()).unwrap().nutrition()->calories, 320);
+
+  // nobody uses it: no meal is read or reported
+  cc::models::Food rice = oats;
+  rice.setId("0303");
+  rice.setBarcode("0303");
+  food_service->addManualFood(rice);
+  EXPECT_EQ(invalidated.size(), 1);
+
+  meal_service.deleteMeal(breakfast.id());
+  EXPECT_EQ(meal_service.mealsUsingFood("0101"), std::vector<int>{dinner.id()});
+  meal_service.clear_data_base();
+  EXPECT_TRUE(meal_service.mealsUsingFood("0101").empty());
+}
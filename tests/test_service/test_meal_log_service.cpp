@@ -1,5 +1,8 @@
+#include "fake_off_client.hpp"
 #include "models/meal_log.hpp"
+#include "services/FoodService.hpp"
 #include "services/MealService.hpp"
+#include "storage/JsonFoodRepository.hpp"
 #include "storage/JsonMealRepository.hpp"
 #include "utils/Result.hpp"
 #include <chrono>
@@ -149,3 +152,57 @@ TEST_F(MealServiceTest, deleteMeal) {
   EXPECT_EQ(meal_service.listMeals().unwrap().size(), 0);
   std::remove(path_to_meal_temp_db.c_str());
 }
+
+TEST_F(MealServiceTest, nutrition_is_materialized_and_follows_food_updates) {
+  auto meal_repo =
+      std::make_shared<cc::storage::JsonMealRepository>(path_to_meal_temp_db);
+  auto food_repo = std::make_shared<cc::storage::JsonFoodRepository>(
+      "/tmp/cc_UT_test_service_meal_food_db.json");
+  auto food_service =
+      std::make_shared<FoodService>(food_repo, std::make_shared<FakeOffClient>());
+  food_service->clear_data_base();
+  cc::models::Food oats;
+  oats.setId("0101");
+  oats.setBarcode("0101");
+  oats.setName("oats");
+  oats.setBrand("brand");
+  oats.setCaloriesPer100g(400);
+  oats.setNutrients({{cc::models::NutrientType::Protein, 10, "g"},
+                     {cc::models::NutrientType::Carbs, 60, "g"},
+                     {cc::models::NutrientType::Fat, 8, "g"}});
+  food_service->addManualFood(oats);
+
+  MealService meal_service{meal_repo};
+  meal_service.setFoodService(food_service);
+  meal_service.clear_data_base();
+  cc::models::MealLog breakfast;
+  breakfast.setFoodItems({{"0101", 50}});
+  meal_service.addNewMeal(breakfast);
+
+  auto stored = meal_service.getById(breakfast.id()).unwrap().nutrition();
+  ASSERT_TRUE(stored.has_value());
+  EXPECT_DOUBLE_EQ(stored->calories, 200);
+  EXPECT_DOUBLE_EQ((*stored)[cc::models::NutrientType::Protein], 5);
+  EXPECT_DOUBLE_EQ((*stored)[cc::models::NutrientType::Carbs], 30);
+  EXPECT_DOUBLE_EQ((*stored)[cc::models::NutrientType::Fat], 4);
+
+  oats.setCaloriesPer100g(300);
+  food_service->updateFood(oats);
+  stored = meal_service.getById(breakfast.id()).unwrap().nutrition();
+  ASSERT_TRUE(stored.has_value());
+  EXPECT_DOUBLE_EQ(stored->calories, 150);
+
+  // not stored locally: no totals until the food is fetched
+  cc::models::MealLog lunch;
+  lunch.setFoodItems({{"0101", 100}, {"0202", 100}});
+  meal_service.addNewMeal(lunch);
+  EXPECT_FALSE(meal_service.getById(lunch.id()).unwrap().nutrition().has_value());
+  food_service->getOrFetchByBarcode("0202");
+  stored = meal_service.getById(lunch.id()).unwrap().nutrition();
+  ASSERT_TRUE(stored.has_value());
+  EXPECT_DOUBLE_EQ(stored->calories, 400);
+
+  food_service->clear_data_base();
+  EXPECT_FALSE(meal_service.getById(lunch.id()).unwrap().nutrition().has_value());
+  meal_service.clear_data_base();
+}
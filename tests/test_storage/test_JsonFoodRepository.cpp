@@ -197,3 +197,102 @@ TEST_F(JsonFoodRepositoryTest, clear) {
   food_list = repo_temp.list();
   EXPECT_EQ(food_list.unwrap().size(), 0);
 }
+
+TEST_F(JsonFoodRepositoryTest, getMany_returns_only_existing_ids) {
+  JsonFoodRepository repo_temp{path_to_temp_db};
+  repo_temp.clear();
+  cc::models::Food other = food;
+  other.setId("11111");
+  EXPECT_TRUE(repo_temp.save(food));
+  EXPECT_TRUE(repo_temp.save(other));
+
+  std::vector<std::string> ids{"11111", "missing", "00000"};
+  auto found = repo_temp.getMany(ids);
+  ASSERT_TRUE(found);
+  EXPECT_EQ(found.unwrap().size(), 2);
+
+  JsonFoodRepository wrong_repo{wrong_path_to_temp_db};
+  EXPECT_EQ(wrong_repo.getMany(ids).unwrap_error().code,
+            cc::utils::ErrorCode::NotFound);
+  std::remove(path_to_temp_db.c_str());
+}
+
+TEST_F(JsonFoodRepositoryTest, upsertMany_updates_and_appends_in_one_write) {
+  JsonFoodRepository repo_temp{path_to_temp_db};
+  repo_temp.clear();
+  repo_temp.save(food);
+  const auto version = repo_temp.version();
+
+  cc::models::Food renamed = food;
+  renamed.setName("renamed");
+  cc::models::Food other = food;
+  other.setId("11111");
+  std::vector<cc::models::Food> batch{renamed, other};
+  EXPECT_TRUE(repo_temp.upsertMany(batch));
+
+  auto all = repo_temp.list(0, 10).unwrap();
+  ASSERT_EQ(all.size(), 2);
+  EXPECT_EQ(all[0].name(), "renamed");
+  EXPECT_EQ(all[1].id(), "11111");
+  EXPECT_GT(repo_temp.version(), version);
+
+  JsonFoodRepository wrong{wrong_path_to_temp_db};
+  EXPECT_EQ(wrong.upsertMany(batch).unwrap_error().code,
+            cc::utils::ErrorCode::StorageError);
+  std::remove(path_to_temp_db.c_str());
+}
+
+TEST_F(JsonFoodRepositoryTest, saveMany_appends_only_new_ids) {
+  JsonFoodRepository repo_temp{path_to_temp_db};
+  repo_temp.clear();
+  repo_temp.save(food);
+
+  cc::models::Food renamed = food;
+  renamed.setName("renamed");
+  cc::models::Food other = food;
+  other.setId("11111");
+  cc::models::Food other_renamed = other;
+  other_renamed.setName("renamed");
+  std::vector<cc::models::Food> batch{renamed, other, other_renamed};
+  EXPECT_TRUE(repo_temp.saveMany(batch));
+
+  auto all = repo_temp.list(0, 10).unwrap();
+  ASSERT_EQ(all.size(), 2);
+  EXPECT_EQ(all[0].name(), food.name());
+  EXPECT_EQ(all[1].id(), "11111");
+  EXPECT_EQ(all[1].name(), other.name());
+
+  JsonFoodRepository wrong{wrong_path_to_temp_db};
+  EXPECT_EQ(wrong.saveMany(batch).unwrap_error().code,
+            cc::utils::ErrorCode::StorageError);
+  std::remove(path_to_temp_db.c_str());
+}
+
+TEST_F(JsonFoodRepositoryTest, scan_reads_every_food_in_batches) {
+  JsonFoodRepository repo_temp{path_to_temp_db};
+  repo_temp.clear();
+  std::vector<cc::models::Food> foods;
+  for (int i = 0; i < 5; i++) {
+    cc::models::Food f = food;
+    f.setId(std::to_string(i));
+    foods.push_back(f);
+  }
+  repo_temp.upsertMany(foods);
+
+  std::vector<std::string> ids;
+  std::size_t batches = 0;
+  EXPECT_TRUE(repo_temp.scan(2, [&](std::span<cc::models::Food> batch) {
+    batches++;
+    for (const auto& f : batch) ids.push_back(f.id());
+    return true;
+  }));
+  EXPECT_EQ(batches, 3);
+  EXPECT_EQ(ids, (std::vector<std::string>{"0", "1", "2", "3", "4"}));
+
+  JsonFoodRepository wrong{wrong_path_to_temp_db};
+  EXPECT_EQ(wrong.scan(2, [](std::span<cc::models::Food>) { return true; })
+                .unwrap_error()
+                .code,
+            cc::utils::ErrorCode::NotFound);
+  std::remove(path_to_temp_db.c_str());
+}
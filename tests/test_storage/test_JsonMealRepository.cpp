@@ -279,6 +279,48 @@ repo_temp{wrong_path_to_meal_temp_db};
 cc::utils::ErrorCode::StorageError);
 }
 
+TEST_F(JsonMealRepositoryTest, getMany_returns_only_existing_ids) {
+    JsonMealRepository repo_temp{path_to_meal_temp_db};
+    repo_temp.clear();
+    cc::models::MealLog other = meal;
+    other.setId(meal.id() + 1);
+    EXPECT_TRUE(repo_temp.save(meal));
+    EXPECT_TRUE(repo_temp.save(other));
+
+    std::vector<int> ids{meal.id() + 1, meal.id() + 50, meal.id()};
+    auto found = repo_temp.getMany(ids);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found.unwrap().size(), 2);
+
+    JsonMealRepository wrong{wrong_path_to_meal_temp_db};
+    EXPECT_EQ(wrong.getMany(ids).unwrap_error().code,
+              cc::utils::ErrorCode::NotFound);
+    std::remove(path_to_meal_temp_db.c_str());
+}
+
+TEST_F(JsonMealRepositoryTest, upsertMany_updates_and_appends_in_one_write) {
+    JsonMealRepository repo_temp{path_to_meal_temp_db};
+    repo_temp.clear();
+    EXPECT_TRUE(repo_temp.save(meal));
+
+    cc::models::MealLog renamed = meal;
+    renamed.setName(cc::models::MEALNAME::Dinner);
+    cc::models::MealLog other = meal;
+    other.setId(meal.id() + 1);
+    std::vector<cc::models::MealLog> batch{renamed, other};
+    EXPECT_TRUE(repo_temp.upsertMany(batch));
+
+    auto all = repo_temp.list().unwrap();
+    ASSERT_EQ(all.size(), 2);
+    EXPECT_EQ(all[0].getName(), cc::models::MEALNAME::Dinner);
+    EXPECT_EQ(all[1].id(), meal.id() + 1);
+
+    JsonMealRepository wrong{wrong_path_to_meal_temp_db};
+    EXPECT_EQ(wrong.upsertMany(batch).unwrap_error().code,
+              cc::utils::ErrorCode::StorageError);
+    std::remove(path_to_meal_temp_db.c_str());
+}
+
 TEST_F(JsonMealRepositoryTest, clear) {
     JsonMealRepository
 repo_temp{path_to_meal_temp_db};
@@ -292,3 +334,66 @@ repo_temp.list(); EXPECT_EQ(meal_list.unwrap().size(), 1);
     EXPECT_EQ(meal_list.unwrap().size(), 0);
     std::remove(path_to_meal_temp_db.c_str());
 }
+
+TEST_F(JsonMealRepositoryTest, versions_grow_with_writes_of_their_day) {
+    JsonMealRepository repo_temp{path_to_meal_temp_db};
+    repo_temp.clear();
+    const auto today = std::chrono::floor<std::chrono::days>(meal.gettime());
+    const auto other_day = today - std::chrono::days{3};
+
+    const auto version = repo_temp.version();
+    const auto today_version = repo_temp.dayVersion(today);
+    const auto other_version = repo_temp.dayVersion(other_day);
+
+    repo_temp.save(meal);
+    EXPECT_GT(repo_temp.version(), version);
+    EXPECT_GT(repo_temp.dayVersion(today), today_version);
+    EXPECT_EQ(repo_temp.dayVersion(other_day), other_version);
+
+    // a failed write changes nothing
+    const auto after_save = repo_temp.version();
+    EXPECT_FALSE(repo_temp.remove(meal.id() + 1));
+    EXPECT_EQ(repo_temp.version(), after_save);
+
+    repo_temp.clear();
+    EXPECT_GT(repo_temp.dayVersion(other_day), other_version);
+    std::remove(path_to_meal_temp_db.c_str());
+}
+
+TEST_F(JsonMealRepositoryTest, scanRange_streams_meals_of_the_range_in_batches) {
+    JsonMealRepository repo_temp{path_to_meal_temp_db};
+    repo_temp.clear();
+    const auto today = std::chrono::floor<std::chrono::days>(meal.gettime());
+    std::vector<int> in_range;
+    for (int i = 0; i < 7; i++) {
+        cc::models::MealLog m;
+        m.setName(cc::models::MEALNAME::Lunch);
+        // every other meal is a week earlier
+        m.setTime(meal.gettime() - std::chrono::days{i % 2 ? 7 : 0});
+        repo_temp.save(m);
+        if (i % 2 == 0) in_range.push_back(m.id());
+    }
+
+    std::vector<int> seen;
+    std::vector<std::size_t> batch_sizes;
+    auto res = repo_temp.scanRange(today, today, 3, [&](std::span<cc::models::MealLog> batch) {
+        batch_sizes.push_back(batch.size());
+        for (const auto& m : batch) seen.push_back(m.id());
+        // the sink may write while the scan is running
+        EXPECT_TRUE(repo_temp.upsert(batch.front()));
+        return true;
+    });
+    EXPECT_TRUE(res);
+    EXPECT_EQ(seen, in_range);
+    EXPECT_EQ(batch_sizes, (std::vector<std::size_t>{3, 1}));
+
+    // false stops the scan
+    std::size_t calls = 0;
+    EXPECT_TRUE(repo_temp.scanRange(today - std::chrono::days{7}, today, 2,
+                                    [&](std::span<cc::models::MealLog>) {
+                                        calls++;
+                                        return false;
+                                    }));
+    EXPECT_EQ(calls, 1);
+    std::remove(path_to_meal_temp_db.c_str());
+}
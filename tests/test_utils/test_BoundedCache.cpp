@@ -0,0 +1,122 @@
+#include "utils/BoundedCache.hpp"
+#include "utils/EvictionPolicy.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace cc::utils;
+
+class BoundedCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+};
+
+TEST_F(BoundedCacheTest, lru_evicts_least_recently_used_when_over_budget) {
+  BoundedCache<std::string, int> cache{300, CachePolicy::LRU};
+  cache.put("a", 1, 100);
+  cache.put("b", 2, 100);
+  cache.put("c", 3, 100);
+  EXPECT_EQ(cache.get("a"), 1); // a is now the most recent
+  cache.put("d", 4, 100);       // evicts b
+
+  EXPECT_FALSE(cache.get("b").has_value());
+  EXPECT_EQ(cache.get("a"), 1);
+  EXPECT_EQ(cache.get("c"), 3);
+  EXPECT_EQ(cache.get("d"), 4);
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.entries, 3);
+  EXPECT_EQ(stats.bytes, 300);
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 4);
+  EXPECT_EQ(stats.policy, "LRU");
+}
+
+TEST_F(BoundedCacheTest, entry_larger_than_budget_is_not_cached) {
+  BoundedCache<std::string, int> cache{100};
+  cache.put("big", 1, 101);
+  EXPECT_FALSE(cache.get("big").has_value());
+  EXPECT_EQ(cache.stats().bytes, 0);
+}
+
+TEST_F(BoundedCacheTest, erase_and_clear_invalidate) {
+  BoundedCache<std::string, int> cache{1000};
+  cache.put("a", 1, 10);
+  cache.put("b", 2, 10);
+  cache.erase("a");
+  EXPECT_FALSE(cache.get("a").has_value());
+  EXPECT_EQ(cache.get("b"), 2);
+  cache.clear();
+  EXPECT_FALSE(cache.get("b").has_value());
+  EXPECT_EQ(cache.stats().invalidations, 2);
+  EXPECT_EQ(cache.stats().bytes, 0);
+}
+
+TEST_F(BoundedCacheTest, put_loaded_before_invalidation_is_dropped) {
+  BoundedCache<std::string, int> cache{1000};
+  auto epoch = cache.epoch();
+  cache.erase("a"); // a concurrent write happened after the load started
+  cache.put("a", 1, 10, epoch);
+  EXPECT_FALSE(cache.get("a").has_value());
+  cache.put("a", 2, 10, cache.epoch());
+  EXPECT_EQ(cache.get("a"), 2);
+}
+
+TEST_F(BoundedCacheTest, arc_keeps_frequent_entries_during_a_scan) {
+  BoundedCache<std::string, int> cache{400, CachePolicy::ARC};
+  // hot entries are read twice, so they move to the frequency list
+  for (auto key : {"h1", "h2"}) {
+    cache.put(key, 1, 100);
+    cache.get(key);
+  }
+  // a one-off scan larger than the cache
+  for (int i = 0; i < 20; i++) {
+    cache.put("scan" + std::to_string(i), i, 100);
+  }
+  EXPECT_TRUE(cache.get("h1").has_value());
+  EXPECT_TRUE(cache.get("h2").has_value());
+  EXPECT_LE(cache.stats().bytes, 400);
+  EXPECT_EQ(cache.stats().policy, "ARC");
+
+  // the same scan evicts the hot entries under LRU
+  BoundedCache<std::string, int> lru{400, CachePolicy::LRU};
+  for (auto key : {"h1", "h2"}) {
+    lru.put(key, 1, 100);
+    lru.get(key);
+  }
+  for (int i = 0; i < 20; i++) {
+    lru.put("scan" + std::to_string(i), i, 100);
+  }
+  EXPECT_FALSE(lru.get("h1").has_value());
+}
+
+TEST_F(BoundedCacheTest, arc_ghost_hit_promotes_to_frequency_list) {
+  ArcPolicy<std::string> arc{200};
+  arc.recordInsert("a", 100);
+  arc.recordInsert("b", 100);
+  EXPECT_EQ(arc.evict(), "a"); // a goes to the recency ghost list
+  arc.recordInsert("a", 100);  // ghost hit: a lands in T2, T1 target grows to 100
+  arc.recordInsert("c", 100);
+  // T1 (b, c) is over its target, then T1 is at target so T2 gives way
+  EXPECT_EQ(arc.evict(), "b");
+  EXPECT_EQ(arc.evict(), "a");
+  EXPECT_EQ(arc.evict(), "c");
+}
+
+TEST_F(BoundedCacheTest, arc_new_entry_survives_when_t1_target_is_zero) {
+  BoundedCache<std::string, int> cache{300, CachePolicy::ARC};
+  // every entry is read again, T1 is empty and its target still 0
+  for (auto key : {"a", "b", "c"}) {
+    cache.put(key, 1, 100);
+    cache.get(key);
+  }
+  cache.put("d", 4, 100);
+  // REPLACE ran before d entered T1, so T2 gave way
+  EXPECT_EQ(cache.get("d"), 4);
+  EXPECT_FALSE(cache.get("a").has_value());
+  EXPECT_EQ(cache.stats().evictions, 1);
+}
@@ -0,0 +1,58 @@
+#include "utils/Compression.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace cc::utils;
+
+class CompressionTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+    for (int i = 0; i < 200; i++) {
+      body += "{\"id\":" + std::to_string(i) + ",\"name\":\"granola\",\"kcal\":420.0},";
+    }
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+
+  std::string body;
+};
+
+TEST_F(CompressionTest, negotiates_by_q_value_preferring_gzip) {
+  EXPECT_EQ(negotiateEncoding(""), ContentEncoding::Identity);
+  EXPECT_EQ(negotiateEncoding("br"), ContentEncoding::Identity);
+  EXPECT_EQ(negotiateEncoding("gzip, deflate, br"), ContentEncoding::Gzip);
+  EXPECT_EQ(negotiateEncoding("deflate"), ContentEncoding::Deflate);
+  EXPECT_EQ(negotiateEncoding("gzip;q=0.5, deflate"), ContentEncoding::Deflate);
+  EXPECT_EQ(negotiateEncoding("GZIP ; q=1.0"), ContentEncoding::Gzip);
+  EXPECT_EQ(negotiateEncoding("gzip;q=0, deflate;q=0"), ContentEncoding::Identity);
+  EXPECT_EQ(negotiateEncoding("*"), ContentEncoding::Gzip);
+  EXPECT_EQ(negotiateEncoding("gzip;q=0, *"), ContentEncoding::Deflate);
+}
+
+TEST_F(CompressionTest, round_trips_and_shrinks_json) {
+  for (auto encoding : {ContentEncoding::Gzip, ContentEncoding::Deflate}) {
+    for (int level : {1, 6, 9}) {
+      auto compressed = compress(body, encoding, level);
+      ASSERT_TRUE(compressed);
+      EXPECT_LT(compressed.unwrap().size(), body.size() / 4);
+      auto restored = decompress(compressed.unwrap(), encoding);
+      ASSERT_TRUE(restored);
+      EXPECT_EQ(restored.unwrap(), body);
+    }
+  }
+  // gzip magic bytes
+  auto gzip = compress(body, ContentEncoding::Gzip, 6).unwrap();
+  EXPECT_EQ(static_cast<unsigned char>(gzip[0]), 0x1f);
+  EXPECT_EQ(static_cast<unsigned char>(gzip[1]), 0x8b);
+}
+
+TEST_F(CompressionTest, rejects_corrupt_input) {
+  EXPECT_FALSE(decompress("not compressed", ContentEncoding::Gzip));
+  EXPECT_EQ(compress("", ContentEncoding::Gzip, 6).unwrap().empty(), false);
+  EXPECT_EQ(decompress(compress("", ContentEncoding::Deflate, 6).unwrap(),
+                       ContentEncoding::Deflate)
+                .unwrap(),
+            "");
+}
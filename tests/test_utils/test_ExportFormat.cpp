@@ -0,0 +1,84 @@
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "utils/ExportFormat.hpp"
+#include "utils/date_time_utils.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace cc::utils;
+
+class ExportFormatTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+    food.setId("007");
+    food.setName("Oats, \"rolled\"");
+    food.setBrand(std::string("Demo"));
+    food.setBarcode(std::string("007"));
+    food.setCaloriesPer100g(389);
+    food.setSource(cc::models::SOURCE::Manual);
+    food.setNutrient(cc::models::NutrientType::Protein, 13.5);
+
+    meal.setName(cc::models::MEALNAME::Lunch);
+    meal.setId(4);
+    meal.setTime(fromIso8601("2026-02-02T13:05:00Z"));
+    meal.setFoodItems({{"007", 50}, {"008", 12.5}});
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+
+  cc::models::Food food;
+  cc::models::MealLog meal;
+  JsonWriter w;
+};
+
+TEST_F(ExportFormatTest, csv_fields_are_quoted_only_when_needed) {
+  std::string out;
+  appendCsvField(out, "plain");
+  out += '|';
+  appendCsvField(out, "a,b");
+  out += '|';
+  appendCsvField(out, "say \"hi\"\n");
+  EXPECT_EQ(out, "plain|\"a,b\"|\"say \"\"hi\"\"\n\"");
+  EXPECT_EQ(parseExportFormat(""), ExportFormat::Ndjson);
+  EXPECT_EQ(parseExportFormat("csv"), ExportFormat::Csv);
+  EXPECT_FALSE(parseExportFormat("xml"));
+}
+
+TEST_F(ExportFormatTest, foods_have_a_column_per_nutrient) {
+  std::string out;
+  appendFoodHeader(out, ExportFormat::Csv);
+  appendFood(out, w, food, ExportFormat::Csv);
+  EXPECT_EQ(out,
+            "id,name,brand,barcode,caloriesPer100g,source,Protein,Carbs,Fat,"
+            "Fiber,Sugars,SaturatedFat,Salt,Sodium\n"
+            "007,\"Oats, \"\"rolled\"\"\",Demo,007,389.0,Manual,13.5,,,,,,,\n");
+
+  std::string ndjson;
+  appendFoodHeader(ndjson, ExportFormat::Ndjson);
+  appendFood(ndjson, w, food, ExportFormat::Ndjson);
+  appendFood(ndjson, w, food, ExportFormat::Ndjson);
+  const auto eol = ndjson.find('\n');
+  ASSERT_NE(eol, std::string::npos);
+  EXPECT_EQ(ndjson.substr(0, eol + 1), ndjson.substr(eol + 1));
+  EXPECT_EQ(nlohmann::json::parse(ndjson.substr(0, eol))["id"], "007");
+}
+
+TEST_F(ExportFormatTest, meals_list_items_and_optional_nutrition) {
+  std::string out;
+  appendMealHeader(out, ExportFormat::Csv, false);
+  appendMeal(out, w, meal, ExportFormat::Csv, false);
+  EXPECT_EQ(out, "id,name,tsUtc,foodItems\n"
+                 "4,Lunch,2026-02-02T13:05:00Z,007:50.0;008:12.5\n");
+
+  out.clear();
+  appendMeal(out, w, meal, ExportFormat::Csv, true);
+  EXPECT_EQ(out, "4,Lunch,2026-02-02T13:05:00Z,007:50.0;008:12.5,,,,,,,,,\n");
+  meal.setNutrition(cc::models::NutritionTotals{200, {10, 20, 5}});
+  out.clear();
+  appendMeal(out, w, meal, ExportFormat::Csv, true);
+  EXPECT_EQ(out, "4,Lunch,2026-02-02T13:05:00Z,007:50.0;008:12.5,200.0,10.0,"
+                 "20.0,5.0,0.0,0.0,0.0,0.0,0.0\n");
+}
@@ -0,0 +1,35 @@
+#include "utils/FenwickTree.hpp"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+using namespace cc::utils;
+
+class FenwickTreeTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+};
+
+TEST_F(FenwickTreeTest, range_sums_match_a_plain_array) {
+  std::vector<long> values(100, 0);
+  FenwickTree<long> tree{values.size()};
+  for (std::size_t i = 0; i < values.size(); i++) {
+    values[i] = static_cast<long>(i * 7 % 13) - 6;
+    tree.add(i, values[i]);
+  }
+  tree.add(42, 10);
+  values[42] += 10;
+  for (std::size_t first = 0; first < values.size(); first += 9) {
+    for (std::size_t last = first; last < values.size(); last += 11) {
+      long expected = std::accumulate(values.begin() + first, values.begin() + last + 1, 0L);
+      EXPECT_EQ(tree.range(first, last), expected) << first << ".." << last;
+    }
+  }
+  EXPECT_EQ(tree.prefix(1000), std::accumulate(values.begin(), values.end(), 0L));
+  EXPECT_EQ(tree.range(5, 4), 0);
+}
@@ -0,0 +1,71 @@
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "utils/JsonWriter.hpp"
+#include "utils/Json_utils.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace cc::utils;
+
+class JsonWriterTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+};
+
+TEST_F(JsonWriterTest, writes_nested_containers_with_commas) {
+  JsonWriter w;
+  w.beginObject();
+  w.field("a", 1);
+  w.key("b").beginArray().value(true).null().beginObject().endObject().endArray();
+  w.field("c", std::string("x"));
+  w.key("d").beginArray().endArray();
+  w.endObject();
+  EXPECT_EQ(w.str(), R"({"a":1,"b":[true,null,{}],"c":"x","d":[]})");
+}
+
+TEST_F(JsonWriterTest, escapes_strings) {
+  JsonWriter w;
+  w.value(std::string_view("q\"b\\n\nt\t\x01 é"));
+  EXPECT_EQ(w.str(), "\"q\\\"b\\\\n\\nt\\t\\u0001 é\"");
+  EXPECT_EQ(nlohmann::json::parse(w.str()).get<std::string>(), "q\"b\\n\nt\t\x01 é");
+}
+
+TEST_F(JsonWriterTest, doubles_round_trip_like_nlohmann) {
+  for (double d : {0.0, 389.0, -2.5, 0.1, 1e21, 123456.789, 1.0 / 3.0}) {
+    std::string out;
+    appendDouble(out, d);
+    EXPECT_EQ(nlohmann::json::parse(out).get<double>(), d) << out;
+    EXPECT_EQ(out, nlohmann::json(d).dump()) << out;
+  }
+  std::string out;
+  appendDouble(out, std::numeric_limits<double>::quiet_NaN());
+  EXPECT_EQ(out, "null");
+}
+
+TEST_F(JsonWriterTest, models_match_their_nlohmann_serialization) {
+  cc::models::Food food{"42", "Oats \"fine\"", 389.0,
+                        {{cc::models::NutrientType::Protein, 13.5, "g"},
+                         {cc::models::NutrientType::Sodium, 2, "mg"}},
+                        "42", std::nullopt, std::string("img")};
+  JsonWriter w;
+  writeJson(w, food);
+  EXPECT_EQ(nlohmann::json::parse(w.str()), nlohmann::json(food));
+
+  cc::models::MealLog meal;
+  meal.setFoodItems({{"42", 80}, {"7", 12.5}});
+  cc::models::NutritionTotals totals;
+  totals.calories = 311.2;
+  totals[cc::models::NutrientType::Fat] = 5.5;
+  meal.setNutrition(totals);
+  JsonWriter mw;
+  writeJson(mw, meal);
+  EXPECT_EQ(nlohmann::json::parse(mw.str()), nlohmann::json(meal));
+}
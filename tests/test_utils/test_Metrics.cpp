@@ -0,0 +1,75 @@
+#include "utils/Metrics.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cc::utils;
+
+class MetricsTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+
+  MetricsRegistry registry;
+};
+
+TEST_F(MetricsTest, counters_sum_the_increments_of_every_thread) {
+  auto& family = registry.counter("cc_test_total", "test", {"kind"});
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&family, t] {
+      Counter& counter = family.labels({t % 2 ? "odd" : "even"});
+      for (int i = 0; i < 10000; i++) counter.inc();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(family.labels({"odd"}).value(), 40000u);
+  EXPECT_EQ(family.labels({"even"}).value(), 40000u);
+  // registering again returns the same family
+  EXPECT_EQ(&registry.counter("cc_test_total", "test", {"kind"}), &family);
+  EXPECT_THROW(registry.gauge("cc_test_total", "test"), std::invalid_argument);
+}
+
+TEST_F(MetricsTest, histograms_render_cumulative_buckets) {
+  auto& histogram =
+      registry.histogram("cc_test_seconds", "test \"quoted\"", {"path"}, {0.1, 1});
+  histogram.labels({"/a\"b"}).observe(0.05);
+  histogram.labels({"/a\"b"}).observe(0.5);
+  histogram.labels({"/a\"b"}).observe(0.5);
+  histogram.labels({"/a\"b"}).observe(5.0);
+  registry.gauge("cc_test_in_flight", "test").get().set(3);
+  registry.callback("cc_test_queue", "test", MetricType::Gauge, [] { return 7.5; });
+
+  std::string out;
+  registry.render(out);
+  EXPECT_NE(out.find("# HELP cc_test_seconds test \"quoted\"\n# TYPE cc_test_seconds histogram\n"),
+            std::string::npos)
+      << out;
+  EXPECT_NE(out.find("cc_test_seconds_bucket{path=\"/a\\\"b\",le=\"0.1\"} 1\n"),
+            std::string::npos)
+      << out;
+  EXPECT_NE(out.find("cc_test_seconds_bucket{path=\"/a\\\"b\",le=\"1\"} 3\n"), std::string::npos)
+      << out;
+  EXPECT_NE(out.find("cc_test_seconds_bucket{path=\"/a\\\"b\",le=\"+Inf\"} 4\n"),
+            std::string::npos)
+      << out;
+  EXPECT_NE(out.find("cc_test_seconds_sum{path=\"/a\\\"b\"} 6.05\n"), std::string::npos) << out;
+  EXPECT_NE(out.find("cc_test_seconds_count{path=\"/a\\\"b\"} 4\n"), std::string::npos) << out;
+  EXPECT_NE(out.find("cc_test_in_flight 3\n"), std::string::npos) << out;
+  EXPECT_NE(out.find("# TYPE cc_test_queue gauge\ncc_test_queue 7.5\n"), std::string::npos)
+      << out;
+}
+
+TEST_F(MetricsTest, label_sets_past_the_limit_fold_into_other) {
+  auto& family = registry.counter("cc_test_paths_total", "test", {"path"});
+  for (std::size_t i = 0; i < MAX_LABEL_SETS + 10; i++) {
+    family.labels({"/p" + std::to_string(i)}).inc();
+  }
+  EXPECT_EQ(family.labels({"other"}).value(), 10u);
+  EXPECT_EQ(family.labels({"/p0"}).value(), 1u);
+}
@@ -0,0 +1,104 @@
+#include "models/food.hpp"
+#include "models/meal_log.hpp"
+#include "utils/Json_utils.hpp"
+#include "utils/NdjsonImport.hpp"
+#include <gtest/gtest.h>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace cc::utils;
+
+class NdjsonImportTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+
+  // ids of the foods passed to apply, one vector per batch
+  std::vector<std::vector<std::string>> batches;
+  Result<void> applyResult = Result<void>::ok();
+
+  ImportReport importFoods(const std::string& body, std::size_t batchSize) {
+    return importNdjson<cc::models::Food>(
+        body, batchSize, foodFromRecord,
+        [this](std::span<const cc::models::Food> foods) {
+          std::vector<std::string> ids;
+          for (const auto& food : foods) ids.push_back(food.id());
+          batches.push_back(ids);
+          return applyResult;
+        });
+  }
+};
+
+TEST_F(NdjsonImportTest, applies_valid_lines_in_batches_and_reports_the_rest) {
+  const std::string body =
+      "{\"id\":\"1\",\"name\":\"oats\",\"caloriePer100g\":380}\n"
+      "\n"
+      "not json\r\n"
+      "{\"id\":\"2\",\"name\":\"milk\",\"caloriesPer100g\":64,"
+      "\"nutrient\":[{\"type\":\"Protein\",\"value\":3.4,\"unit\":\"g\"}]}\n"
+      "{\"name\":\"no id\",\"caloriePer100g\":1}\n"
+      "{\"id\":\"3\",\"name\":\"jam\",\"caloriePer100g\":250}";
+
+  auto report = importFoods(body, 2);
+
+  EXPECT_EQ(report.lines, 5);
+  EXPECT_EQ(report.imported, 3);
+  EXPECT_EQ(report.failed, 2);
+  EXPECT_EQ(report.batches, 2);
+  EXPECT_EQ(batches, (std::vector<std::vector<std::string>>{{"1", "2"}, {"3"}}));
+  ASSERT_EQ(report.errors.size(), 2);
+  EXPECT_EQ(report.errors[0].line, 3);
+  EXPECT_EQ(report.errors[0].message, "invalid JSON");
+  EXPECT_EQ(report.errors[1].line, 5);
+  EXPECT_EQ(report.errors[1].message, "missing field: id");
+}
+
+TEST_F(NdjsonImportTest, failed_batch_fails_all_its_lines) {
+  applyResult = Result<void>::fail(ErrorCode::StorageError, "disk full");
+  auto report = importFoods("{\"id\":\"1\",\"name\":\"a\",\"caloriePer100g\":1}\n"
+                            "{\"id\":\"2\",\"name\":\"b\",\"caloriePer100g\":1}\n",
+                            10);
+  EXPECT_EQ(report.imported, 0);
+  EXPECT_EQ(report.failed, 2);
+  ASSERT_EQ(report.errors.size(), 2);
+  EXPECT_EQ(report.errors[1].line, 2);
+  EXPECT_EQ(report.errors[1].message, "disk full");
+}
+
+TEST_F(NdjsonImportTest, non_string_nutrient_unit_fails_only_its_line) {
+  auto report = importFoods(
+      "{\"id\":\"1\",\"name\":\"a\",\"caloriePer100g\":1,"
+      "\"nutrient\":[{\"type\":\"Protein\",\"value\":3,\"unit\":5}]}\n"
+      "{\"id\":\"2\",\"name\":\"b\",\"caloriePer100g\":1}\n",
+      10);
+  EXPECT_EQ(report.imported, 1);
+  EXPECT_EQ(report.failed, 1);
+  ASSERT_EQ(report.errors.size(), 1);
+  EXPECT_EQ(report.errors[0].line, 1);
+  EXPECT_EQ(report.errors[0].message, "nutrient unit is not a string");
+}
+
+TEST_F(NdjsonImportTest, meal_records_are_validated) {
+  auto meal = mealFromRecord(nlohmann::json::parse(
+      R"({"name":"Lunch","tsUtc":"2026-02-02T13:05:00Z","foodItems":[{"foodId":"1","grams":40}]})"));
+  ASSERT_TRUE(meal);
+  EXPECT_EQ(meal.unwrap().getName(), cc::models::MEALNAME::Lunch);
+  EXPECT_EQ(toIso8601(meal.unwrap().gettime()), "2026-02-02T13:05:00Z");
+  ASSERT_EQ(meal.unwrap().food_items().size(), 1);
+  EXPECT_EQ(meal.unwrap().food_items()[0].second, 40);
+
+  auto stored_format = mealFromRecord(
+      nlohmann::json::parse(R"({"name":"Dinner","foodItems":[["007",50]]})"));
+  ASSERT_TRUE(stored_format);
+  EXPECT_EQ(stored_format.unwrap().food_items()[0].first, "007");
+
+  EXPECT_FALSE(mealFromRecord(nlohmann::json::parse(R"({"name":"Brunch"})")));
+  EXPECT_FALSE(mealFromRecord(nlohmann::json::parse(R"({"name":"Lunch","tsUtc":"yesterday"})")));
+  EXPECT_FALSE(mealFromRecord(
+      nlohmann::json::parse(R"({"name":"Lunch","foodItems":[{"foodId":"1","grams":-5}]})")));
+}
@@ -0,0 +1,58 @@
+#include "utils/PostingList.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+using namespace cc::utils;
+
+class PostingListTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+};
+
+TEST_F(PostingListTest, add_remove_contains_across_containers) {
+  PostingList list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_TRUE(list.add(7));
+  EXPECT_FALSE(list.add(7));
+  EXPECT_TRUE(list.add(70000)); // second container
+  EXPECT_TRUE(list.add(3));
+  EXPECT_EQ(list.size(), 3);
+  EXPECT_TRUE(list.contains(70000));
+  EXPECT_FALSE(list.contains(70001));
+  EXPECT_EQ(list.values(), (std::vector<std::uint32_t>{3, 7, 70000}));
+
+  EXPECT_TRUE(list.remove(70000));
+  EXPECT_FALSE(list.remove(70000));
+  EXPECT_EQ(list.values(), (std::vector<std::uint32_t>{3, 7}));
+}
+
+TEST_F(PostingListTest, dense_container_switches_to_bitmap_and_back) {
+  PostingList list;
+  std::set<std::uint32_t> expected;
+  for (std::uint32_t i = 0; i < 10000; i++) {
+    list.add(i * 3);
+    expected.insert(i * 3);
+  }
+  EXPECT_EQ(list.size(), expected.size());
+  EXPECT_TRUE(list.contains(2997));
+  EXPECT_FALSE(list.contains(2998));
+  // a dense bitmap is much smaller than 10000 array entries
+  EXPECT_LT(list.approximateBytes(), 10000 * sizeof(std::uint16_t));
+
+  for (std::uint32_t i = 0; i < 9000; i++) {
+    EXPECT_TRUE(list.remove(i * 3));
+    expected.erase(i * 3);
+  }
+  EXPECT_EQ(list.size(), expected.size());
+  auto values = list.values();
+  EXPECT_EQ(std::set<std::uint32_t>(values.begin(), values.end()), expected);
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+}
@@ -0,0 +1,58 @@
+#include "utils/RateLimiter.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace cc::utils;
+using namespace std::chrono_literals;
+
+class RateLimiterTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+
+  RateLimiter::clock::time_point t0{};
+};
+
+TEST_F(RateLimiterTest, allows_the_burst_then_refills_at_the_rate) {
+  RateLimiter limiter{RateLimit{2, 3}};
+  for (int i = 0; i < 3; i++) EXPECT_TRUE(limiter.acquire("a", t0).allowed) << i;
+  auto refused = limiter.acquire("a", t0);
+  EXPECT_FALSE(refused.allowed);
+  EXPECT_EQ(refused.retryAfter, std::chrono::duration_cast<RateLimiter::clock::duration>(500ms));
+  // other clients have their own bucket
+  EXPECT_TRUE(limiter.acquire("b", t0).allowed);
+  // one token back after half a second, never more than the burst
+  EXPECT_TRUE(limiter.acquire("a", t0 + 500ms).allowed);
+  EXPECT_FALSE(limiter.acquire("a", t0 + 500ms).allowed);
+  for (int i = 0; i < 3; i++) EXPECT_TRUE(limiter.acquire("a", t0 + 60s).allowed) << i;
+  EXPECT_FALSE(limiter.acquire("a", t0 + 60s).allowed);
+
+  RateLimiter off{RateLimit{}};
+  for (int i = 0; i < 100; i++) EXPECT_TRUE(off.acquire("a", t0).allowed);
+}
+
+TEST_F(RateLimiterTest, bounds_the_number_of_buckets) {
+  RateLimiter limiter{RateLimit{1, 1}, 64};
+  for (int i = 0; i < 1000; i++) limiter.acquire("client" + std::to_string(i), t0);
+  EXPECT_LE(limiter.size(), 64u);
+  // refilled buckets are dropped first
+  for (int i = 0; i < 1000; i++) limiter.acquire("late" + std::to_string(i), t0 + 10s);
+  EXPECT_LE(limiter.size(), 64u);
+}
+
+TEST_F(RateLimiterTest, parses_rate_and_burst) {
+  auto limit = parseRateLimit("5:10");
+  ASSERT_TRUE(limit);
+  EXPECT_EQ(limit.unwrap().ratePerSecond, 5);
+  EXPECT_EQ(limit.unwrap().burst, 10);
+  EXPECT_EQ(parseRateLimit("0.5").unwrap().burst, 1);
+  EXPECT_EQ(parseRateLimit("20").unwrap().burst, 20);
+  for (const char* bad : {"", "x", "5:", "5:0", "-1", "5:10:2"}) {
+    EXPECT_FALSE(parseRateLimit(bad)) << bad;
+  }
+}
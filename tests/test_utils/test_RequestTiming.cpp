@@ -0,0 +1,54 @@
+#include "utils/RequestTiming.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using namespace cc::utils;
+
+class RequestTimingTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+    bindRequestTimings(nullptr);
+  }
+};
+
+TEST_F(RequestTimingTest, nested_phases_are_counted_exclusively) {
+  using namespace std::chrono_literals;
+  RequestTimings timings;
+  bindRequestTimings(&timings);
+  {
+    PhaseTimer enrich(TimingPhase::Enrich);
+    std::this_thread::sleep_for(5ms);
+    {
+      PhaseTimer storage(TimingPhase::Storage);
+      std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_EQ(timings.active(), TimingPhase::Enrich);
+  }
+  EXPECT_FALSE(timings.active().has_value());
+  EXPECT_EQ(timings.count(TimingPhase::Enrich), 1u);
+  EXPECT_EQ(timings.count(TimingPhase::Storage), 1u);
+  EXPECT_GE(timings.duration(TimingPhase::Storage), 20ms);
+  EXPECT_GE(timings.duration(TimingPhase::Enrich), 5ms);
+  // the storage time is not counted again in enrich
+  EXPECT_LT(timings.duration(TimingPhase::Enrich), 20ms);
+}
+
+TEST_F(RequestTimingTest, formats_entered_phases_and_total) {
+  RequestTimings timings;
+  { PhaseTimer unbound(TimingPhase::Parse); }
+  EXPECT_EQ(timings.count(TimingPhase::Parse), 0u);
+
+  bindRequestTimings(&timings);
+  { PhaseTimer parse(TimingPhase::Parse); }
+  { PhaseTimer off(TimingPhase::OffFetch); }
+  const std::string header =
+      formatServerTiming(timings, std::chrono::microseconds(2500));
+  EXPECT_TRUE(header.starts_with("parse;dur=")) << header;
+  EXPECT_NE(header.find(", off;dur="), std::string::npos) << header;
+  EXPECT_EQ(header.find("storage"), std::string::npos) << header;
+  EXPECT_TRUE(header.ends_with(", total;dur=2.500")) << header;
+}
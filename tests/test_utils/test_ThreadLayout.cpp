@@ -0,0 +1,45 @@
+#include "utils/ThreadLayout.hpp"
+#include "utils/ThreadPool.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace cc::utils;
+
+class ThreadLayoutTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+};
+
+TEST_F(ThreadLayoutTest, parses_and_formats_cpu_lists) {
+  auto cpus = parseCpuList("8,0-3, 2,10-11");
+  ASSERT_TRUE(cpus);
+  EXPECT_EQ(cpus.unwrap(), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(formatCpuList(cpus.unwrap()), "0-3,8,10-11");
+  EXPECT_EQ(formatCpuList(std::vector<int>{5}), "5");
+
+  for (const char* bad : {"", "a", "3-1", "1,,2", "-1", "0-", "node:x"}) {
+    auto parsed = parseCpuSpec(bad);
+    ASSERT_FALSE(parsed) << bad;
+    EXPECT_EQ(parsed.unwrap_error().code, ErrorCode::InvalidInput) << bad;
+  }
+  EXPECT_EQ(parseCpuSpec("node:4096").unwrap_error().code, ErrorCode::NotFound);
+}
+
+TEST_F(ThreadLayoutTest, pinned_pool_workers_still_run_tasks) {
+  // cpu 0 always exists, every worker is pinned to it
+  ThreadPool pool{3, {0}};
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 8; i++) futures.push_back(pool.submit([i] { return i * i; }));
+  for (int i = 0; i < 8; i++) EXPECT_EQ(pool.wait(futures[i]), i * i);
+
+  ThreadLayout layout;
+  layout.httpWorkers = 3;
+  EXPECT_EQ(httpThreads(layout), 4u);
+  EXPECT_NE(describeLayout(layout, pool.size()).find("1 acceptor + 3 workers"),
+            std::string::npos);
+}
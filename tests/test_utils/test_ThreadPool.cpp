@@ -0,0 +1,54 @@
+#include "utils/ThreadPool.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace cc::utils;
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+  void SetUp() override { // runs BEFORE each TEST_F
+  }
+
+  void TearDown() override { // runs AFTER each TEST_F
+                             // nothing to destroy //
+  }
+};
+
+TEST_F(ThreadPoolTest, parallel_for_visits_every_index_once) {
+  ThreadPool pool{4};
+  for (std::size_t count : {0, 1, 7, 64, 1000, 1001}) {
+    std::vector<std::atomic<int>> visits(count);
+    pool.parallelFor(count, 16, [&](std::size_t begin, std::size_t end) {
+      ASSERT_LE(begin, end);
+      for (std::size_t i = begin; i < end; i++) visits[i]++;
+    });
+    for (std::size_t i = 0; i < count; i++) {
+      EXPECT_EQ(visits[i].load(), 1) << "count " << count << " index " << i;
+    }
+  }
+}
+
+TEST_F(ThreadPoolTest, parallel_for_runs_small_inputs_inline) {
+  ThreadPool pool{4};
+  int calls = 0;
+  pool.parallelFor(31, 16, [&](std::size_t begin, std::size_t end) {
+    calls++;
+    EXPECT_EQ(begin, 0u);
+    EXPECT_EQ(end, 31u);
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(ThreadPoolTest, parallel_for_rethrows_after_all_chunks_finished) {
+  ThreadPool pool{4};
+  std::atomic<std::size_t> done{0};
+  EXPECT_THROW(pool.parallelFor(1000, 10,
+                                [&](std::size_t begin, std::size_t end) {
+                                  done += end - begin;
+                                  if (begin == 0) throw std::runtime_error("boom");
+                                }),
+               std::runtime_error);
+  EXPECT_EQ(done.load(), 1000u);
+}